@@ -0,0 +1,137 @@
+/*  Copyright (c) 2026 Michael Hansen
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in
+    all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE. */
+
+#ifndef _ST_ALLOC_STATS_H
+#define _ST_ALLOC_STATS_H
+
+#include "st_config.h"
+
+#include <cstddef>
+
+namespace ST
+{
+    // Per-thread counters of the heap traffic generated by ST::buffer,
+    // ST::string and ST::string_stream.  The counters are only maintained
+    // when string_theory is configured with ST_ENABLE_ALLOC_STATS;
+    // otherwise snapshot() always returns zeros.
+    struct alloc_stats
+    {
+        size_t allocations;     // Heap blocks allocated
+        size_t deallocations;   // Heap blocks freed
+        size_t bytes;           // Total bytes allocated
+        size_t sso_hits;        // Buffers that fit in inline storage
+        size_t copies;          // Buffer contents duplicated by copy
+
+        static constexpr bool enabled() noexcept
+        {
+#if defined(ST_ENABLE_ALLOC_STATS)
+            return true;
+#else
+            return false;
+#endif
+        }
+
+        // Counters for the calling thread since it started or since the
+        // last call to reset()
+        ST_NODISCARD
+        static alloc_stats snapshot() noexcept;
+
+        static void reset() noexcept;
+
+        // Difference between two snapshots, e.g. the traffic generated by
+        // the code between them
+        ST_NODISCARD
+        alloc_stats operator-(const alloc_stats &other) const noexcept
+        {
+            alloc_stats result;
+            result.allocations = allocations - other.allocations;
+            result.deallocations = deallocations - other.deallocations;
+            result.bytes = bytes - other.bytes;
+            result.sso_hits = sso_hits - other.sso_hits;
+            result.copies = copies - other.copies;
+            return result;
+        }
+    };
+}
+
+namespace _ST_PRIVATE
+{
+#if defined(ST_ENABLE_ALLOC_STATS)
+    inline ST::alloc_stats &thread_alloc_stats() noexcept
+    {
+        static thread_local ST::alloc_stats stats = { 0, 0, 0, 0, 0 };
+        return stats;
+    }
+#endif
+
+    template <typename char_T>
+    char_T *alloc_chars(size_t count)
+    {
+        char_T *chars = new char_T[count];
+#if defined(ST_ENABLE_ALLOC_STATS)
+        ST::alloc_stats &stats = thread_alloc_stats();
+        stats.allocations += 1;
+        stats.bytes += count * sizeof(char_T);
+#endif
+        return chars;
+    }
+
+    template <typename char_T>
+    void free_chars(char_T *chars) noexcept
+    {
+#if defined(ST_ENABLE_ALLOC_STATS)
+        if (chars)
+            thread_alloc_stats().deallocations += 1;
+#endif
+        delete[] chars;
+    }
+
+    inline void count_sso_hit() noexcept
+    {
+#if defined(ST_ENABLE_ALLOC_STATS)
+        thread_alloc_stats().sso_hits += 1;
+#endif
+    }
+
+    inline void count_copy() noexcept
+    {
+#if defined(ST_ENABLE_ALLOC_STATS)
+        thread_alloc_stats().copies += 1;
+#endif
+    }
+}
+
+inline ST::alloc_stats ST::alloc_stats::snapshot() noexcept
+{
+#if defined(ST_ENABLE_ALLOC_STATS)
+    return _ST_PRIVATE::thread_alloc_stats();
+#else
+    return alloc_stats { 0, 0, 0, 0, 0 };
+#endif
+}
+
+inline void ST::alloc_stats::reset() noexcept
+{
+#if defined(ST_ENABLE_ALLOC_STATS)
+    _ST_PRIVATE::thread_alloc_stats() = alloc_stats { 0, 0, 0, 0, 0 };
+#endif
+}
+
+#endif // _ST_ALLOC_STATS_H
@@ -22,6 +22,7 @@
 #define _ST_CHARBUFFER_H
 
 #include "st_assert.h"
+#include "st_alloc_stats.h"
 
 #include <cstddef>      // Needed for ptrdiff_t
 #include <iterator>     // Needed for reverse_iterator
@@ -46,6 +47,8 @@ namespace ST
     ST_DEPRECATED_IN_3_4("Use empty initializer {} instead.")
     static constexpr null_t null;
 
+    class string;
+
     template <typename char_T>
     class buffer
     {
@@ -66,6 +69,24 @@ namespace ST
         typedef std::reverse_iterator<const_iterator> const_reverse_iterator;
 
     private:
+#if defined(ST_COMPACT_BUFFER)
+        // Compact layout:  The heap pointer shares storage with the inline
+        // characters, since only one of them is ever in use.
+        enum
+        {
+            local_length = ST_COMPACT_SSO_SIZE / sizeof(char_T)
+        };
+
+        size_t m_size;
+        union
+        {
+            char_T *m_ref;
+            char_T m_data[local_length];
+        };
+
+        static_assert(sizeof(char_T) * (local_length - 1) >= sizeof(char_T *),
+                      "ST_COMPACT_SSO_SIZE is too small to hold a pointer and ASCII hint");
+#else
         enum
         {
             local_length = (ST_MAX_SSO_LENGTH * sizeof(char_T)) > ST_MAX_SSO_SIZE
@@ -76,6 +97,7 @@ namespace ST
         char_T *m_chars;
         size_t m_size;
         char_T m_data[local_length];
+#endif
 
         typedef std::char_traits<char_T> traits_t;
 
@@ -84,34 +106,120 @@ namespace ST
             return m_size >= local_length;
         }
 
+        char_T *chars() noexcept
+        {
+#if defined(ST_COMPACT_BUFFER)
+            return is_reffed() ? m_ref : m_data;
+#else
+            return m_chars;
+#endif
+        }
+
+        const char_T *chars() const noexcept
+        {
+#if defined(ST_COMPACT_BUFFER)
+            return is_reffed() ? m_ref : m_data;
+#else
+            return m_chars;
+#endif
+        }
+
+        // Select the storage matching the current m_size:  either the
+        // provided heap block, or the inline storage if heap is null.
+        void attach(char_T *heap) noexcept
+        {
+#if defined(ST_COMPACT_BUFFER)
+            if (heap)
+                m_ref = heap;
+#else
+            m_chars = heap ? heap : m_data;
+#endif
+        }
+
+        // ST::string caches whether its contents are pure ASCII.  Heap
+        // buffers keep the answer in the last element of their otherwise
+        // unused inline storage; it is reset whenever the contents may be
+        // modified.  Short buffers don't store it, and are cheap to check.
+        enum
+        {
+            ascii_slot = local_length - 1,
+            ascii_unknown = 0,
+            ascii_only = 1,
+            not_ascii = 2
+        };
+
+        int ascii_hint() const noexcept
+        {
+            return is_reffed() ? static_cast<int>(m_data[ascii_slot]) : ascii_unknown;
+        }
+
+        void set_ascii_hint(bool ascii) noexcept
+        {
+            if (is_reffed())
+                m_data[ascii_slot] = static_cast<char_T>(ascii ? ascii_only : not_ascii);
+        }
+
+        void copy_ascii_hint(const buffer<char_T> &other) noexcept
+        {
+            if (is_reffed())
+                m_data[ascii_slot] = other.m_data[ascii_slot];
+        }
+
+        void reset_ascii_hint() noexcept
+        {
+            if (is_reffed())
+                m_data[ascii_slot] = static_cast<char_T>(ascii_unknown);
+        }
+
+        friend class ST::string;
+
+        char_T *new_storage(size_t size)
+        {
+            if (size >= local_length)
+                return _ST_PRIVATE::alloc_chars<char_T>(size + 1);
+
+            _ST_PRIVATE::count_sso_hit();
+            return nullptr;
+        }
+
     public:
+#if defined(ST_COMPACT_BUFFER)
+        constexpr buffer() noexcept
+            : m_size(), m_data() { }
+#else
         constexpr buffer() noexcept
             : m_chars(m_data), m_size(), m_data() { }
+#endif
 
         ST_DEPRECATED_IN_3_4("Use empty initializer {} instead.")
         constexpr buffer(const null_t &) noexcept
-            : m_chars(m_data), m_size(), m_data() { }
+            : buffer() { }
 
         buffer(const buffer<char_T> &copy)
-            : m_size()
+            : m_size(copy.m_size)
         {
+            _ST_PRIVATE::count_copy();
             if (copy.is_reffed()) {
-                m_chars = new char_T[copy.m_size + 1];
-                traits_t::copy(m_chars, copy.m_chars, copy.m_size);
-                m_chars[copy.m_size] = 0;
+                char_T *heap = _ST_PRIVATE::alloc_chars<char_T>(m_size + 1);
+                traits_t::copy(heap, copy.chars(), m_size);
+                heap[m_size] = 0;
+                attach(heap);
+                copy_ascii_hint(copy);
             } else {
                 traits_t::copy(m_data, copy.m_data, local_length);
-                m_chars = m_data;
+                attach(nullptr);
             }
-            m_size = copy.m_size;
         }
 
         buffer(buffer<char_T> &&move) noexcept
             : m_size(move.m_size)
         {
-            m_chars = is_reffed() ? move.m_chars : m_data;
+            char_T *heap = move.is_reffed() ? move.chars() : nullptr;
             traits_t::copy(m_data, move.m_data, local_length);
+            attach(heap);
             move.m_size = 0;
+            move.m_data[0] = 0;
+            move.attach(nullptr);
         }
 
         buffer(const char_T *data, size_t size)
@@ -119,18 +227,20 @@ namespace ST
         {
             ST_ASSERT(data || (size == 0),
                       "buffer cannot be constructed with non-zero size and NULL data");
-            m_chars = is_reffed() ? new char_T[m_size + 1] : m_data;
+            attach(new_storage(m_size));
+            char_T *dest = chars();
             if (data)
-                traits_t::move(m_chars, data, m_size);
-            m_chars[m_size] = 0;
+                traits_t::move(dest, data, m_size);
+            dest[m_size] = 0;
         }
 
         buffer(size_t count, char_T fill)
             : m_size(count), m_data()
         {
-            m_chars = is_reffed() ? new char_T[m_size + 1] : m_data;
-            traits_t::assign(m_chars, m_size, fill);
-            m_chars[m_size] = 0;
+            attach(new_storage(m_size));
+            char_T *dest = chars();
+            traits_t::assign(dest, m_size, fill);
+            dest[m_size] = 0;
         }
 
         ~buffer() noexcept
@@ -141,7 +251,7 @@ namespace ST
 #   pragma GCC diagnostic ignored "-Wfree-nonheap-object"
 #endif
             if (is_reffed())
-                delete[] m_chars;
+                _ST_PRIVATE::free_chars(chars());
 #if defined(__GNUC__)
 #   pragma GCC diagnostic pop
 #endif
@@ -150,11 +260,11 @@ namespace ST
         void clear() noexcept
         {
             if (is_reffed())
-                delete[] m_chars;
+                _ST_PRIVATE::free_chars(chars());
 
-            m_chars = m_data;
             m_size = 0;
             traits_t::assign(m_data, local_length, 0);
+            attach(nullptr);
         }
 
         ST_DEPRECATED_IN_3_4("Use clear() instead")
@@ -169,30 +279,39 @@ namespace ST
             if (this == &copy)
                 return *this;
 
-            if (is_reffed()) {
-                delete[] m_chars;
-                m_size = 0;
-            }
+            _ST_PRIVATE::count_copy();
+            char_T *heap = copy.is_reffed()
+                         ? _ST_PRIVATE::alloc_chars<char_T>(copy.m_size + 1) : nullptr;
+            if (is_reffed())
+                _ST_PRIVATE::free_chars(chars());
 
-            if (copy.is_reffed()) {
-                m_chars = new char_T[copy.m_size + 1];
-                traits_t::copy(m_chars, copy.m_chars, copy.m_size);
-                m_chars[copy.m_size] = 0;
+            m_size = copy.m_size;
+            if (heap) {
+                traits_t::copy(heap, copy.chars(), m_size);
+                heap[m_size] = 0;
             } else {
                 traits_t::copy(m_data, copy.m_data, local_length);
-                m_chars = m_data;
             }
-            m_size = copy.m_size;
+            attach(heap);
+            copy_ascii_hint(copy);
             return *this;
         }
 
         buffer<char_T> &operator=(buffer<char_T> &&move) noexcept ST_LIFETIME_BOUND
         {
-            std::swap(m_chars, move.m_chars);
-            std::swap(m_size, move.m_size);
+            if (this == &move)
+                return *this;
+
+            if (is_reffed())
+                _ST_PRIVATE::free_chars(chars());
+
+            char_T *heap = move.is_reffed() ? move.chars() : nullptr;
+            m_size = move.m_size;
             traits_t::copy(m_data, move.m_data, local_length);
-            if (!is_reffed())
-                m_chars = m_data;
+            attach(heap);
+            move.m_size = 0;
+            move.m_data[0] = 0;
+            move.attach(nullptr);
             return *this;
         }
 
@@ -275,19 +394,23 @@ namespace ST
         }
 
         ST_NODISCARD
-        char_T *data() noexcept ST_LIFETIME_BOUND { return m_chars; }
+        char_T *data() noexcept ST_LIFETIME_BOUND
+        {
+            reset_ascii_hint();
+            return chars();
+        }
 
         ST_NODISCARD
-        const char_T *data() const noexcept ST_LIFETIME_BOUND { return m_chars; }
+        const char_T *data() const noexcept ST_LIFETIME_BOUND { return chars(); }
 
         ST_NODISCARD
-        const char_T *c_str() const noexcept ST_LIFETIME_BOUND { return m_chars; }
+        const char_T *c_str() const noexcept ST_LIFETIME_BOUND { return chars(); }
 
         ST_NODISCARD
         const char_T *c_str(const char_T *substitute ST_LIFETIME_BOUND)
             const noexcept ST_LIFETIME_BOUND
         {
-            return empty() ? substitute : m_chars;
+            return empty() ? substitute : chars();
         }
 
         ST_NODISCARD
@@ -301,7 +424,8 @@ namespace ST
         {
             if (index >= size())
                 throw std::out_of_range("Character index out of range");
-            return m_chars[index];
+            reset_ascii_hint();
+            return chars()[index];
         }
 
         ST_NODISCARD
@@ -309,67 +433,78 @@ namespace ST
         {
             if (index >= size())
                 throw std::out_of_range("Character index out of range");
-            return m_chars[index];
+            return chars()[index];
         }
 
         ST_NODISCARD
         char_T &operator[](size_t index) noexcept ST_LIFETIME_BOUND
         {
-            return m_chars[index];
+            reset_ascii_hint();
+            return chars()[index];
         }
 
         ST_NODISCARD
         const char_T &operator[](size_t index) const noexcept ST_LIFETIME_BOUND
         {
-            return m_chars[index];
+            return chars()[index];
         }
 
         ST_NODISCARD
         char_T &front() noexcept ST_LIFETIME_BOUND
         {
-            return m_chars[0];
+            reset_ascii_hint();
+            return chars()[0];
         }
 
         ST_NODISCARD
         const char_T &front() const noexcept ST_LIFETIME_BOUND
         {
-            return m_chars[0];
+            return chars()[0];
         }
 
         ST_NODISCARD
         char_T &back() noexcept ST_LIFETIME_BOUND
         {
-            return empty() ? m_chars[0] : m_chars[m_size - 1];
+            reset_ascii_hint();
+            return empty() ? chars()[0] : chars()[m_size - 1];
         }
 
         ST_NODISCARD
         const char_T &back() const noexcept ST_LIFETIME_BOUND
         {
-            return empty() ? m_chars[0] : m_chars[m_size - 1];
+            return empty() ? chars()[0] : chars()[m_size - 1];
         }
 
         ST_NODISCARD
-        iterator begin() noexcept ST_LIFETIME_BOUND { return m_chars; }
+        iterator begin() noexcept ST_LIFETIME_BOUND
+        {
+            reset_ascii_hint();
+            return chars();
+        }
 
         ST_NODISCARD
-        const_iterator begin() const noexcept ST_LIFETIME_BOUND { return m_chars; }
+        const_iterator begin() const noexcept ST_LIFETIME_BOUND { return chars(); }
 
         ST_NODISCARD
-        const_iterator cbegin() const noexcept ST_LIFETIME_BOUND { return m_chars; }
+        const_iterator cbegin() const noexcept ST_LIFETIME_BOUND { return chars(); }
 
         ST_NODISCARD
-        iterator end() noexcept ST_LIFETIME_BOUND { return m_chars + m_size; }
+        iterator end() noexcept ST_LIFETIME_BOUND
+        {
+            reset_ascii_hint();
+            return chars() + m_size;
+        }
 
         ST_NODISCARD
         const_iterator end() const noexcept ST_LIFETIME_BOUND
         {
-            return m_chars + m_size;
+            return chars() + m_size;
         }
 
         ST_NODISCARD
         const_iterator cend() const noexcept ST_LIFETIME_BOUND
         {
-            return m_chars + m_size;
+            return chars() + m_size;
         }
 
         ST_NODISCARD
@@ -410,20 +545,70 @@ namespace ST
 
         void allocate(size_t size)
         {
+            char_T *heap = new_storage(size);
             if (is_reffed())
-                delete[] m_chars;
+                _ST_PRIVATE::free_chars(chars());
             else
                 traits_t::assign(m_data, local_length, 0);
 
             m_size = size;
-            m_chars = is_reffed() ? new char_T[m_size + 1] : m_data;
-            m_chars[m_size] = 0;
+            attach(heap);
+            reset_ascii_hint();
+            chars()[m_size] = 0;
         }
 
         void allocate(size_t size, char_T fill)
         {
             allocate(size);
-            traits_t::assign(m_chars, size, fill);
+            traits_t::assign(chars(), size, fill);
+        }
+
+        // Detach the buffer's storage and return it to the caller, who
+        // becomes responsible for freeing it with delete[].  The returned
+        // array always holds size() + 1 characters including the nul
+        // terminator.  Heap storage is handed over directly; buffers short
+        // enough to be stored inline are copied into a new allocation.
+        // The buffer is left empty.
+        ST_NODISCARD
+        char_T *release()
+        {
+            char_T *result;
+            if (is_reffed()) {
+                result = chars();
+            } else {
+                _ST_PRIVATE::count_copy();
+                result = _ST_PRIVATE::alloc_chars<char_T>(m_size + 1);
+                traits_t::copy(result, m_data, m_size + 1);
+            }
+
+            m_size = 0;
+            traits_t::assign(m_data, local_length, 0);
+            attach(nullptr);
+            return result;
+        }
+
+        // Take ownership of an array of size + 1 characters allocated with
+        // new char_T[], whose last character must be a nul terminator.
+        // Long arrays are used in place; short ones are copied into the
+        // inline storage and freed immediately.
+        void adopt(char_T *data, size_t size)
+        {
+            ST_ASSERT(data, "buffer::adopt passed null buffer");
+            ST_ASSERT(data[size] == 0, "buffer::adopt passed unterminated buffer");
+
+            if (is_reffed())
+                _ST_PRIVATE::free_chars(chars());
+
+            m_size = size;
+            if (is_reffed()) {
+                attach(data);
+                reset_ascii_hint();
+            } else {
+                traits_t::assign(m_data, local_length, 0);
+                traits_t::copy(m_data, data, size);
+                _ST_PRIVATE::free_chars(data);
+                attach(nullptr);
+            }
         }
 
         ST_NODISCARD
@@ -0,0 +1,107 @@
+/*  Copyright (c) 2026 Michael Hansen
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in
+    all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE. */
+
+#ifndef _ST_CHARSET_H
+#define _ST_CHARSET_H
+
+#include "st_config.h"
+
+#include <cstddef>      // Needed for size_t
+#include <string>       // Needed for char_traits
+
+namespace ST
+{
+    // A set of bytes, stored as a 256-bit membership table.  Building one
+    // once and passing it to trim() or tokenize() avoids searching the
+    // character list for every byte of the input.
+    class char_set
+    {
+    public:
+        char_set() noexcept : m_bits() { }
+
+        explicit char_set(const char *chars) noexcept : m_bits()
+        {
+            add(chars);
+        }
+
+        char_set(const char *chars, size_t size) noexcept : m_bits()
+        {
+            add(chars, size);
+        }
+
+        void add(char ch) noexcept
+        {
+            const unsigned char uch = static_cast<unsigned char>(ch);
+            m_bits[uch >> 6] |= 1ULL << (uch & 63);
+        }
+
+        void add(const char *chars) noexcept
+        {
+            if (chars)
+                add(chars, std::char_traits<char>::length(chars));
+        }
+
+        void add(const char *chars, size_t size) noexcept
+        {
+            for (size_t i = 0; i < size; ++i)
+                add(chars[i]);
+        }
+
+        ST_NODISCARD
+        bool contains(char ch) const noexcept
+        {
+            const unsigned char uch = static_cast<unsigned char>(ch);
+            return ((m_bits[uch >> 6] >> (uch & 63)) & 1) != 0;
+        }
+
+        // Returns the first byte in [begin, end) that is in the set, or end
+        ST_NODISCARD
+        const char *find(const char *begin, const char *end) const noexcept
+        {
+            while (begin != end && !contains(*begin))
+                ++begin;
+            return begin;
+        }
+
+        // Returns the first byte in [begin, end) that is not in the set, or end
+        ST_NODISCARD
+        const char *skip(const char *begin, const char *end) const noexcept
+        {
+            while (begin != end && contains(*begin))
+                ++begin;
+            return begin;
+        }
+
+        // Returns one past the last byte in [begin, end) that is not in the
+        // set, or begin
+        ST_NODISCARD
+        const char *skip_back(const char *begin, const char *end) const noexcept
+        {
+            while (end != begin && contains(end[-1]))
+                --end;
+            return end;
+        }
+
+    private:
+        unsigned long long m_bits[4];
+    };
+}
+
+#endif // _ST_CHARSET_H
@@ -27,7 +27,8 @@
 
 namespace ST
 {
-    inline string hex_encode(const void *data, size_t size)
+    inline string hex_encode(const void *data, size_t size,
+                             bool upper_case = false)
     {
         if (size == 0)
             return ST::string();
@@ -37,13 +38,50 @@ namespace ST
 
         ST::char_buffer buffer;
         buffer.allocate(size * 2);
-        _ST_PRIVATE::hex_encode(buffer.data(), data, size);
+        _ST_PRIVATE::hex_encode(buffer.data(), data, size, upper_case);
         return ST::string::from_validated(std::move(buffer));
     }
 
-    inline string hex_encode(const char_buffer &data)
+    inline string hex_encode(const char_buffer &data, bool upper_case = false)
     {
-        return hex_encode(data.data(), data.size());
+        return hex_encode(data.data(), data.size(), upper_case);
+    }
+
+    // Write exactly size * 2 hex characters to output, without a nul
+    // terminator.  Returns the number of characters written.
+    inline size_t hex_encode_to(char *output, const void *data, size_t size,
+                                bool upper_case = false) noexcept
+    {
+        _ST_PRIVATE::hex_encode(output, data, size, upper_case);
+        return size * 2;
+    }
+
+    ST_NODISCARD
+    constexpr size_t hex_records_size(size_t record_size, size_t count,
+                                      char terminator = 0) noexcept
+    {
+        return (record_size * 2 + (terminator ? 1 : 0)) * count;
+    }
+
+    // Encode count contiguous records of record_size bytes each into a
+    // single output buffer of at least hex_records_size() characters.  If
+    // terminator is not nul, it is written after each encoded record.
+    // Returns the number of characters written.
+    inline size_t hex_encode_records(char *output, const void *records,
+                                     size_t record_size, size_t count,
+                                     char terminator = 0,
+                                     bool upper_case = false) noexcept
+    {
+        char *outp = output;
+        auto sp = static_cast<const unsigned char *>(records);
+        for (size_t i = 0; i < count; ++i) {
+            _ST_PRIVATE::hex_encode(outp, sp, record_size, upper_case);
+            outp += record_size * 2;
+            sp += record_size;
+            if (terminator)
+                *outp++ = terminator;
+        }
+        return static_cast<size_t>(outp - output);
     }
 
     inline ST_ssize_t hex_decode(const string &hex, void *output,
@@ -52,6 +90,12 @@ namespace ST
         return _ST_PRIVATE::hex_decode(hex, output, output_size);
     }
 
+    inline ST_ssize_t hex_decode(const char *hex, size_t size, void *output,
+                                 size_t output_size) noexcept
+    {
+        return _ST_PRIVATE::hex_decode(hex, size, output, output_size);
+    }
+
     inline char_buffer hex_decode(const string &hex)
     {
         if ((hex.size() % 2) != 0)
@@ -69,7 +113,16 @@ namespace ST
         return result;
     }
 
-    inline string base64_encode(const void *data, size_t size)
+    enum class base64_alphabet_t
+    {
+        base64_standard,    // RFC 4648 section 4: A-Z a-z 0-9 + /
+        base64_url          // RFC 4648 section 5: A-Z a-z 0-9 - _
+    };
+    ST_ENUM_CONSTANT(base64_alphabet_t, base64_standard);
+    ST_ENUM_CONSTANT(base64_alphabet_t, base64_url);
+
+    inline string base64_encode(const void *data, size_t size,
+                                base64_alphabet_t alphabet, bool pad = true)
     {
         if (size == 0)
             return ST::string();
@@ -78,11 +131,23 @@ namespace ST
             throw std::invalid_argument("null data pointer passed to base64_encode");
 
         ST::char_buffer buffer;
-        buffer.allocate(_ST_PRIVATE::b64_encode_size(size));
-        _ST_PRIVATE::b64_encode(buffer.data(), data, size);
+        buffer.allocate(_ST_PRIVATE::b64_encode_size(size, pad));
+        _ST_PRIVATE::b64_encode(buffer.data(), data, size,
+                                alphabet == base64_url, pad);
         return ST::string::from_validated(std::move(buffer));
     }
 
+    inline string base64_encode(const void *data, size_t size)
+    {
+        return base64_encode(data, size, base64_standard);
+    }
+
+    inline string base64_encode(const char_buffer &data,
+                                base64_alphabet_t alphabet, bool pad = true)
+    {
+        return base64_encode(data.data(), data.size(), alphabet, pad);
+    }
+
     inline string base64_encode(const char_buffer &data)
     {
         return base64_encode(data.data(), data.size());
@@ -94,6 +159,211 @@ namespace ST
         return _ST_PRIVATE::b64_decode(base64, output, output_size);
     }
 
+    // Unlike the overload above, this accepts input with or without
+    // trailing '=' padding.
+    inline ST_ssize_t base64_decode(const string &base64, void *output,
+                                    size_t output_size,
+                                    base64_alphabet_t alphabet) noexcept
+    {
+        return _ST_PRIVATE::b64_decode(base64.c_str(), base64.size(), output,
+                                       output_size, alphabet == base64_url, false);
+    }
+
+    // Incremental base64 encoder.  Input may be fed in arbitrarily sized
+    // pieces; up to two bytes are carried between calls to update() until
+    // a complete 3-byte group is available.
+    class base64_encoder
+    {
+    public:
+        explicit base64_encoder(base64_alphabet_t alphabet = base64_standard,
+                                bool pad = true) noexcept
+            : m_carry(), m_carry_size(), m_url(alphabet == base64_url),
+              m_pad(pad) { }
+
+        // Upper bound on the number of characters written by a single
+        // update() call for size bytes of input.  finish() writes at
+        // most 4 characters.
+        ST_NODISCARD
+        static constexpr size_t max_output_size(size_t size) noexcept
+        {
+            return ((size + 2) / 3) * 4;
+        }
+
+        size_t update(const void *data, size_t size, char *output) noexcept
+        {
+            char *outp = output;
+            auto sp = static_cast<const unsigned char *>(data);
+
+            if (m_carry_size) {
+                while (m_carry_size < 3 && size) {
+                    m_carry[m_carry_size++] = *sp++;
+                    --size;
+                }
+                if (m_carry_size < 3)
+                    return 0;
+
+                const unsigned char *cp = m_carry;
+                size_t carry_size = 3;
+                _ST_PRIVATE::b64_encode_groups(outp, cp, carry_size, m_url);
+                m_carry_size = 0;
+            }
+
+            _ST_PRIVATE::b64_encode_groups(outp, sp, size, m_url);
+            while (size--)
+                m_carry[m_carry_size++] = *sp++;
+
+            return static_cast<size_t>(outp - output);
+        }
+
+        // Encode any carried bytes, returning the number of characters
+        // written.  The encoder is ready for a new stream afterwards.
+        size_t finish(char *output) noexcept
+        {
+            char *outp = output;
+            _ST_PRIVATE::b64_encode_tail(outp, m_carry, m_carry_size, m_url, m_pad);
+            m_carry_size = 0;
+            return static_cast<size_t>(outp - output);
+        }
+
+        void reset() noexcept { m_carry_size = 0; }
+
+    private:
+        unsigned char m_carry[3];
+        size_t m_carry_size;
+        bool m_url, m_pad;
+    };
+
+    // Incremental base64 decoder.  Trailing '=' padding is optional, and
+    // whitespace may optionally be skipped anywhere in the input.  Once
+    // update() or finish() reports an error, the decoder must be reset()
+    // before further use.
+    class base64_decoder
+    {
+    public:
+        explicit base64_decoder(base64_alphabet_t alphabet = base64_standard,
+                                bool skip_whitespace = false) noexcept
+            : m_bits(), m_count(), m_pad_seen(), m_pad_needed(), m_error(),
+              m_url(alphabet == base64_url), m_skip_whitespace(skip_whitespace) { }
+
+        // Upper bound on the number of bytes written by a single update()
+        // call for size characters of input.  finish() writes at most 2
+        // bytes.
+        ST_NODISCARD
+        static constexpr size_t max_output_size(size_t size) noexcept
+        {
+            return ((size + 3) / 4) * 3;
+        }
+
+        // Returns the number of bytes written, or -1 on invalid input
+        ST_ssize_t update(const char *data, size_t size, void *output) noexcept
+        {
+            if (m_error)
+                return -1;
+
+            char *outp = static_cast<char *>(output);
+            auto sp = reinterpret_cast<const unsigned char *>(data);
+            auto end = sp + size;
+            const signed char *b64_values = _ST_PRIVATE::b64_values(m_url);
+
+            while (sp < end) {
+                if (m_count == 0 && m_pad_needed == 0) {
+                    // Decode whole groups directly until something that
+                    // needs special handling turns up
+                    const size_t groups = static_cast<size_t>(end - sp) & ~size_t(3);
+                    (void)_ST_PRIVATE::b64_decode_groups(outp, sp, groups, m_url);
+                    if (sp == end)
+                        break;
+                }
+
+                const unsigned char ch = *sp++;
+                const int value = b64_values[ch];
+                if (value >= 0 && m_pad_needed == 0) {
+                    m_bits = (m_bits << 6) | static_cast<unsigned int>(value);
+                    if (++m_count == 4) {
+                        *outp++ = static_cast<char>(m_bits >> 16);
+                        *outp++ = static_cast<char>(m_bits >> 8);
+                        *outp++ = static_cast<char>(m_bits);
+                        m_bits = 0;
+                        m_count = 0;
+                    }
+                } else if (ch == '=') {
+                    if (m_pad_needed == 0) {
+                        if (m_count < 2)
+                            return fail();
+                        m_pad_needed = 4 - m_count;
+                        flush_partial(outp);
+                    }
+                    if (++m_pad_seen > m_pad_needed)
+                        return fail();
+                } else if (!(m_skip_whitespace && is_space(ch))) {
+                    return fail();
+                }
+            }
+
+            return outp - static_cast<char *>(output);
+        }
+
+        // Flush a final unpadded group, returning the number of bytes
+        // written or -1 if the input was truncated or incorrectly padded.
+        // The decoder is ready for a new stream afterwards.
+        ST_ssize_t finish(void *output) noexcept
+        {
+            if (m_error || m_count == 1 || m_pad_seen != m_pad_needed)
+                return fail_reset();
+
+            char *outp = static_cast<char *>(output);
+            if (m_pad_needed == 0)
+                flush_partial(outp);
+            reset();
+            return outp - static_cast<char *>(output);
+        }
+
+        void reset() noexcept
+        {
+            m_bits = 0;
+            m_count = 0;
+            m_pad_seen = 0;
+            m_pad_needed = 0;
+            m_error = false;
+        }
+
+    private:
+        unsigned int m_bits;
+        unsigned int m_count;
+        unsigned int m_pad_seen, m_pad_needed;
+        bool m_error;
+        bool m_url, m_skip_whitespace;
+
+        static bool is_space(unsigned char ch) noexcept
+        {
+            return ch == ' ' || (ch >= '\t' && ch <= '\r');
+        }
+
+        void flush_partial(char *&outp) noexcept
+        {
+            if (m_count == 2) {
+                *outp++ = static_cast<char>(m_bits >> 4);
+            } else if (m_count == 3) {
+                *outp++ = static_cast<char>(m_bits >> 10);
+                *outp++ = static_cast<char>(m_bits >> 2);
+            }
+            m_bits = 0;
+            m_count = 0;
+        }
+
+        ST_ssize_t fail() noexcept
+        {
+            m_error = true;
+            return -1;
+        }
+
+        ST_ssize_t fail_reset() noexcept
+        {
+            reset();
+            return -1;
+        }
+    };
+
     inline char_buffer base64_decode(const string &base64)
     {
         ST_ssize_t decode_size = _ST_PRIVATE::b64_decode_size(base64.size(), base64.c_str());
@@ -109,6 +379,48 @@ namespace ST
         ST_ASSERT(written == decode_size, "Conversion didn't match expected length");
         return result;
     }
+
+    // Decode with the given alphabet, accepting input with or without
+    // trailing '=' padding.  If skip_whitespace is set, line breaks and
+    // other whitespace are ignored wherever they appear.
+    inline char_buffer base64_decode(const string &base64,
+                                     base64_alphabet_t alphabet,
+                                     bool skip_whitespace = false)
+    {
+        ST::char_buffer result;
+        if (!skip_whitespace) {
+            ST_ssize_t decode_size = _ST_PRIVATE::b64_decode_size(base64.size(),
+                                            base64.c_str(), false);
+            if (decode_size < 0)
+                throw codec_error("Invalid base64 input length");
+
+            result.allocate(decode_size);
+            ST_ssize_t written = _ST_PRIVATE::b64_decode(base64.c_str(), base64.size(),
+                                            result.data(), decode_size,
+                                            alphabet == base64_url, false);
+            if (written < 0)
+                throw codec_error("Invalid character in base64 input");
+
+            ST_ASSERT(written == decode_size, "Conversion didn't match expected length");
+            return result;
+        }
+
+        // The decoded size isn't known up front, so decode into a block
+        // sized for the worst case and hand it to the buffer as-is.
+        base64_decoder decoder(alphabet, true);
+        char *data = _ST_PRIVATE::alloc_chars<char>(
+                base64_decoder::max_output_size(base64.size()) + 3);
+        ST_ssize_t written = decoder.update(base64.c_str(), base64.size(), data);
+        ST_ssize_t tail = (written < 0) ? -1 : decoder.finish(data + written);
+        if (tail < 0) {
+            _ST_PRIVATE::free_chars(data);
+            throw codec_error("Invalid base64 input");
+        }
+
+        data[written + tail] = 0;
+        result.adopt(data, static_cast<size_t>(written + tail));
+        return result;
+    }
 }
 
 #endif // _ST_CODECS_H
@@ -21,14 +21,111 @@
 #ifndef _ST_CODECS_PRIV_H
 #define _ST_CODECS_PRIV_H
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#   include <emmintrin.h>
+#   define _ST_CODECS_SSE2
+#endif
+
+#if defined(__SSSE3__)
+#   include <tmmintrin.h>
+#   define _ST_CODECS_SSSE3
+#endif
+
 namespace _ST_PRIVATE
 {
-    inline void hex_encode(char *output, const void *data, size_t size) noexcept
+#if defined(_ST_CODECS_SSE2)
+    // Expand 16 bytes into 32 hex characters per iteration
+    inline void hex_encode_sse2(char *&output, const unsigned char *&sp,
+                                size_t &size, bool upper_case) noexcept
     {
-        static constexpr const char hex_chars[] = "0123456789abcdef";
-        static_assert(sizeof(hex_chars) - 1 == 16, "Missing hex characters");
+        const __m128i low_mask = _mm_set1_epi8(0x0F);
+        const __m128i nine = _mm_set1_epi8(9);
+        const __m128i zero_char = _mm_set1_epi8('0');
+        const __m128i alpha_offset = _mm_set1_epi8(upper_case ? 'A' - '0' - 10
+                                                              : 'a' - '0' - 10);
+
+        while (size >= 16) {
+            const __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i *>(sp));
+            const __m128i hi = _mm_and_si128(_mm_srli_epi16(in, 4), low_mask);
+            const __m128i lo = _mm_and_si128(in, low_mask);
+
+            __m128i first = _mm_unpacklo_epi8(hi, lo);
+            __m128i second = _mm_unpackhi_epi8(hi, lo);
+            first = _mm_add_epi8(_mm_add_epi8(first, zero_char),
+                        _mm_and_si128(_mm_cmpgt_epi8(first, nine), alpha_offset));
+            second = _mm_add_epi8(_mm_add_epi8(second, zero_char),
+                        _mm_and_si128(_mm_cmpgt_epi8(second, nine), alpha_offset));
+
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(output), first);
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(output + 16), second);
+            output += 32;
+            sp += 16;
+            size -= 16;
+        }
+    }
 
+    // Convert 16 hex characters to their nibble values, or return false
+    // if any of them is not a hex digit
+    inline bool hex_values_sse2(__m128i &values, const unsigned char *sp) noexcept
+    {
+        const __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i *>(sp));
+        const __m128i folded = _mm_or_si128(in, _mm_set1_epi8(0x20));
+        const __m128i digit = _mm_and_si128(_mm_cmpgt_epi8(in, _mm_set1_epi8('0' - 1)),
+                                            _mm_cmplt_epi8(in, _mm_set1_epi8('9' + 1)));
+        const __m128i alpha = _mm_and_si128(_mm_cmpgt_epi8(folded, _mm_set1_epi8('a' - 1)),
+                                            _mm_cmplt_epi8(folded, _mm_set1_epi8('f' + 1)));
+        if (_mm_movemask_epi8(_mm_or_si128(digit, alpha)) != 0xFFFF)
+            return false;
+
+        values = _mm_or_si128(
+                _mm_and_si128(digit, _mm_sub_epi8(in, _mm_set1_epi8('0'))),
+                _mm_and_si128(alpha, _mm_sub_epi8(folded, _mm_set1_epi8('a' - 10))));
+        return true;
+    }
+
+    // Pack 32 hex characters into 16 bytes per iteration.  Stops at the
+    // first block containing a non-hex character, leaving it for the
+    // scalar decoder to reject.
+    inline void hex_decode_sse2(char *&output, const unsigned char *&sp,
+                                size_t &count) noexcept
+    {
+        const __m128i low_byte = _mm_set1_epi16(0x00F0);
+
+        while (count >= 16) {
+            __m128i first, second;
+            if (!hex_values_sse2(first, sp) || !hex_values_sse2(second, sp + 16))
+                break;
+
+            // Each 16-bit lane holds the high nibble in its low byte
+            first = _mm_or_si128(_mm_and_si128(_mm_slli_epi16(first, 4), low_byte),
+                                 _mm_srli_epi16(first, 8));
+            second = _mm_or_si128(_mm_and_si128(_mm_slli_epi16(second, 4), low_byte),
+                                  _mm_srli_epi16(second, 8));
+
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(output),
+                             _mm_packus_epi16(first, second));
+            output += 16;
+            sp += 32;
+            count -= 16;
+        }
+    }
+#endif
+
+    inline void hex_encode(char *output, const void *data, size_t size,
+                           bool upper_case = false) noexcept
+    {
         auto sp = static_cast<const unsigned char *>(data);
+
+#if defined(_ST_CODECS_SSE2)
+        hex_encode_sse2(output, sp, size, upper_case);
+#endif
+
+        static constexpr const char hex_lower[] = "0123456789abcdef";
+        static constexpr const char hex_upper[] = "0123456789ABCDEF";
+        static_assert(sizeof(hex_lower) - 1 == 16, "Missing hex characters");
+        static_assert(sizeof(hex_upper) - 1 == 16, "Missing hex characters");
+
+        const char *hex_chars = upper_case ? hex_upper : hex_lower;
         while (size) {
             unsigned char byte = *sp++;
             *output++ = hex_chars[(byte >> 4) & 0x0F];
@@ -37,10 +134,10 @@ namespace _ST_PRIVATE
         }
     }
 
-    inline ST_ssize_t hex_decode(const ST::string &hex, void *output,
+    inline ST_ssize_t hex_decode(const char *hex, size_t size, void *output,
                                  size_t output_size) noexcept
     {
-        static constexpr const int hex_values[] = {
+        static constexpr const signed char hex_values[] = {
             /* 00 */ -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
             /* 10 */ -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
             /* 20 */ -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
@@ -58,12 +155,12 @@ namespace _ST_PRIVATE
             /* E0 */ -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
             /* F0 */ -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
         };
-        static_assert(sizeof(hex_values) / sizeof(int) == 0x100, "Missing hex values");
+        static_assert(sizeof(hex_values) == 0x100, "Missing hex values");
 
-        if ((hex.size() % 2) != 0)
+        if ((size % 2) != 0)
             return -1;
 
-        size_t decode_size = hex.size() / 2;
+        size_t decode_size = size / 2;
         if (!output)
             return decode_size;
 
@@ -71,30 +168,106 @@ namespace _ST_PRIVATE
             return -1;
 
         char *outp = reinterpret_cast<char *>(output);
-        char *endp = outp + decode_size;
-        auto sp = reinterpret_cast<const unsigned char *>(hex.c_str());
+        auto sp = reinterpret_cast<const unsigned char *>(hex);
+        size_t count = decode_size;
+
+#if defined(_ST_CODECS_SSE2)
+        hex_decode_sse2(outp, sp, count);
+#endif
 
-        while (outp < endp) {
+        while (count) {
             int bits[2] = { hex_values[sp[0]], hex_values[sp[1]] };
-            if (bits[0] < 0 || bits[1] < 0)
+            if ((bits[0] | bits[1]) < 0)
                 return -1;
 
             *outp++ = (bits[0] << 4 | bits[1]);
             sp += 2;
+            --count;
         }
 
         return outp - reinterpret_cast<char *>(output);
     }
 
-    inline size_t b64_encode_size(size_t size)
+    inline ST_ssize_t hex_decode(const ST::string &hex, void *output,
+                                 size_t output_size) noexcept
     {
-        return ((size + 2) / 3) * 4;
+        return hex_decode(hex.c_str(), hex.size(), output, output_size);
     }
 
-    inline ST_ssize_t b64_decode_size(size_t size, const char *data)
+    ST_NODISCARD
+    inline const char *b64_chars(bool url) noexcept
     {
-        if ((size % 4) != 0)
-            return -1;
+        static constexpr const char std_chars[] =
+                "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+        static constexpr const char url_chars[] =
+                "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+        static_assert(sizeof(std_chars) - 1 == 64, "Missing base64 characters");
+        static_assert(sizeof(url_chars) - 1 == 64, "Missing base64url characters");
+
+        return url ? url_chars : std_chars;
+    }
+
+    ST_NODISCARD
+    inline const signed char *b64_values(bool url) noexcept
+    {
+        static constexpr const signed char std_values[] = {
+            /* 00 */ -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+            /* 10 */ -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+            /* 20 */ -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 62, -1, -1, -1, 63,
+            /* 30 */ 52, 53, 54, 55, 56, 57, 58, 59, 60, 61, -1, -1, -1, -1, -1, -1,
+            /* 40 */ -1,  0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 12, 13, 14,
+            /* 50 */ 15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, -1, -1, -1, -1, -1,
+            /* 60 */ -1, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 37, 38, 39, 40,
+            /* 70 */ 41, 42, 43, 44, 45, 46, 47, 48, 49, 50, 51, -1, -1, -1, -1, -1,
+            /* 80 */ -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+            /* 90 */ -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+            /* A0 */ -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+            /* B0 */ -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+            /* C0 */ -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+            /* D0 */ -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+            /* E0 */ -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+            /* F0 */ -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+        };
+        static constexpr const signed char url_values[] = {
+            /* 00 */ -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+            /* 10 */ -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+            /* 20 */ -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 62, -1, -1,
+            /* 30 */ 52, 53, 54, 55, 56, 57, 58, 59, 60, 61, -1, -1, -1, -1, -1, -1,
+            /* 40 */ -1,  0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 12, 13, 14,
+            /* 50 */ 15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, -1, -1, -1, -1, 63,
+            /* 60 */ -1, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 37, 38, 39, 40,
+            /* 70 */ 41, 42, 43, 44, 45, 46, 47, 48, 49, 50, 51, -1, -1, -1, -1, -1,
+            /* 80 */ -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+            /* 90 */ -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+            /* A0 */ -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+            /* B0 */ -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+            /* C0 */ -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+            /* D0 */ -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+            /* E0 */ -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+            /* F0 */ -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+        };
+        static_assert(sizeof(std_values) == 0x100, "Missing base64 values");
+        static_assert(sizeof(url_values) == 0x100, "Missing base64url values");
+
+        return url ? url_values : std_values;
+    }
+
+    inline size_t b64_encode_size(size_t size, bool pad = true)
+    {
+        if (pad)
+            return ((size + 2) / 3) * 4;
+        return (size / 3) * 4 + ((size % 3) ? (size % 3) + 1 : 0);
+    }
+
+    inline ST_ssize_t b64_decode_size(size_t size, const char *data,
+                                      bool require_padding = true)
+    {
+        if ((size % 4) != 0) {
+            // Unpadded input may end with a partial group of 2 or 3 chars
+            if (require_padding || (size % 4) == 1)
+                return -1;
+            return static_cast<ST_ssize_t>((size / 4) * 3 + (size % 4) - 1);
+        }
 
         size_t result = (size / 4) * 3;
         if (size > 0 && data[size - 1] == '=')
@@ -105,35 +278,135 @@ namespace _ST_PRIVATE
         return static_cast<ST_ssize_t>(result);
     }
 
-    inline void b64_encode(char *output, const void *data, size_t size) noexcept
+#if defined(_ST_CODECS_SSSE3)
+    // Encode 12 input bytes into 16 characters per iteration, as long as
+    // at least 16 input bytes remain to be loaded.
+    inline void b64_encode_ssse3(char *&output, const unsigned char *&sp,
+                                 size_t &size, bool url) noexcept
     {
-        static constexpr const char b64_chars[] =
-                "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
-        static_assert(sizeof(b64_chars) - 1 == 64, "Missing base64 characters");
+        const __m128i shuffle = _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7,
+                                             4, 5, 3, 4, 1, 2, 0, 1);
+        const __m128i shift_lut = _mm_setr_epi8(
+                'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                static_cast<char>(url ? '-' - 62 : '+' - 62),
+                static_cast<char>(url ? '_' - 63 : '/' - 63), 'A', 0, 0);
+
+        while (size >= 16) {
+            __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i *>(sp));
+            in = _mm_shuffle_epi8(in, shuffle);
+
+            // Split each 24-bit group into four 6-bit indices
+            const __m128i t0 = _mm_and_si128(in, _mm_set1_epi32(0x0fc0fc00));
+            const __m128i t1 = _mm_mulhi_epu16(t0, _mm_set1_epi32(0x04000040));
+            const __m128i t2 = _mm_and_si128(in, _mm_set1_epi32(0x003f03f0));
+            const __m128i t3 = _mm_mullo_epi16(t2, _mm_set1_epi32(0x01000010));
+            const __m128i indices = _mm_or_si128(t1, t3);
+
+            // Map each index range to the offset of its ASCII character
+            __m128i offsets = _mm_subs_epu8(indices, _mm_set1_epi8(51));
+            const __m128i upper = _mm_cmpgt_epi8(_mm_set1_epi8(26), indices);
+            offsets = _mm_or_si128(offsets, _mm_and_si128(upper, _mm_set1_epi8(13)));
+            offsets = _mm_shuffle_epi8(shift_lut, offsets);
+
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(output),
+                             _mm_add_epi8(indices, offsets));
+            output += 16;
+            sp += 12;
+            size -= 12;
+        }
+    }
 
-        auto sp = static_cast<const unsigned char *>(data);
+    // Decode 16 characters into 12 output bytes per iteration.  The output
+    // is written 16 bytes at a time, so at least 24 input characters must
+    // remain.  Stops at the first block containing anything other than
+    // base64 characters, leaving it for the scalar decoder.
+    inline void b64_decode_ssse3(char *&output, const unsigned char *&sp,
+                                 size_t &count, bool url) noexcept
+    {
+        const char ch62 = url ? '-' : '+';
+        const char ch63 = url ? '_' : '/';
+
+        while (count >= 24) {
+            const __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i *>(sp));
+            const __m128i upper = _mm_and_si128(_mm_cmpgt_epi8(in, _mm_set1_epi8('A' - 1)),
+                                                _mm_cmplt_epi8(in, _mm_set1_epi8('Z' + 1)));
+            const __m128i lower = _mm_and_si128(_mm_cmpgt_epi8(in, _mm_set1_epi8('a' - 1)),
+                                                _mm_cmplt_epi8(in, _mm_set1_epi8('z' + 1)));
+            const __m128i digit = _mm_and_si128(_mm_cmpgt_epi8(in, _mm_set1_epi8('0' - 1)),
+                                                _mm_cmplt_epi8(in, _mm_set1_epi8('9' + 1)));
+            const __m128i is62 = _mm_cmpeq_epi8(in, _mm_set1_epi8(ch62));
+            const __m128i is63 = _mm_cmpeq_epi8(in, _mm_set1_epi8(ch63));
+
+            const __m128i valid = _mm_or_si128(_mm_or_si128(upper, lower),
+                                  _mm_or_si128(digit, _mm_or_si128(is62, is63)));
+            if (_mm_movemask_epi8(valid) != 0xFFFF)
+                break;
+
+            __m128i shift = _mm_and_si128(upper, _mm_set1_epi8(-'A'));
+            shift = _mm_or_si128(shift, _mm_and_si128(lower, _mm_set1_epi8(26 - 'a')));
+            shift = _mm_or_si128(shift, _mm_and_si128(digit, _mm_set1_epi8(52 - '0')));
+            shift = _mm_or_si128(shift, _mm_and_si128(is62, _mm_set1_epi8(static_cast<char>(62 - ch62))));
+            shift = _mm_or_si128(shift, _mm_and_si128(is63, _mm_set1_epi8(static_cast<char>(63 - ch63))));
+            const __m128i values = _mm_add_epi8(in, shift);
+
+            // Pack four 6-bit values into each 24-bit group
+            __m128i merged = _mm_maddubs_epi16(values, _mm_set1_epi32(0x01400140));
+            merged = _mm_madd_epi16(merged, _mm_set1_epi32(0x00011000));
+            merged = _mm_shuffle_epi8(merged, _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8,
+                                                            14, 13, 12, -1, -1, -1, -1));
+
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(output), merged);
+            output += 12;
+            sp += 16;
+            count -= 16;
+        }
+    }
+#endif
+
+    // Encode all complete 3-byte groups, leaving the remainder in size
+    inline void b64_encode_groups(char *&output, const unsigned char *&sp,
+                                  size_t &size, bool url) noexcept
+    {
+#if defined(_ST_CODECS_SSSE3)
+        b64_encode_ssse3(output, sp, size, url);
+#endif
+
+        const char *b64_chars = _ST_PRIVATE::b64_chars(url);
         while (size > 2) {
-            *output++ = b64_chars[sp[0] >> 2];
-            *output++ = b64_chars[((sp[0] & 0x03) << 4) | ((sp[1] & 0xF0) >> 4)];
-            *output++ = b64_chars[((sp[1] & 0x0F) << 2) | ((sp[2] & 0xC0) >> 6)];
-            *output++ = b64_chars[sp[2] & 0x3F];
+            const unsigned int bits = (static_cast<unsigned int>(sp[0]) << 16)
+                                    | (static_cast<unsigned int>(sp[1]) << 8)
+                                    | sp[2];
+            output[0] = b64_chars[(bits >> 18) & 0x3F];
+            output[1] = b64_chars[(bits >> 12) & 0x3F];
+            output[2] = b64_chars[(bits >> 6) & 0x3F];
+            output[3] = b64_chars[bits & 0x3F];
+            output += 4;
             size -= 3;
             sp += 3;
         }
+    }
 
-        // Final bytes treated specially
+    // Encode the final 1 or 2 bytes
+    inline void b64_encode_tail(char *&output, const unsigned char *sp,
+                                size_t size, bool url, bool pad) noexcept
+    {
+        const char *b64_chars = _ST_PRIVATE::b64_chars(url);
         switch (size) {
         case 2:
             *output++ = b64_chars[sp[0] >> 2];
             *output++ = b64_chars[((sp[0] & 0x03) << 4) | ((sp[1] & 0xF0) >> 4)];
             *output++ = b64_chars[((sp[1] & 0x0F) << 2)];
-            *output++ = '=';
+            if (pad)
+                *output++ = '=';
             break;
         case 1:
             *output++ = b64_chars[sp[0] >> 2];
             *output++ = b64_chars[((sp[0] & 0x03) << 4)];
-            *output++ = '=';
-            *output++ = '=';
+            if (pad) {
+                *output++ = '=';
+                *output++ = '=';
+            }
             break;
         case 0:
             break;
@@ -143,30 +416,52 @@ namespace _ST_PRIVATE
         }
     }
 
-    inline ST_ssize_t b64_decode(const ST::string &base64, void *output,
-                                 size_t output_size) noexcept
+    inline void b64_encode(char *output, const void *data, size_t size,
+                           bool url = false, bool pad = true) noexcept
     {
-        static constexpr const int b64_values[] = {
-            /* 00 */ -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
-            /* 10 */ -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
-            /* 20 */ -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 62, -1, -1, -1, 63,
-            /* 30 */ 52, 53, 54, 55, 56, 57, 58, 59, 60, 61, -1, -1, -1, -1, -1, -1,
-            /* 40 */ -1,  0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 12, 13, 14,
-            /* 50 */ 15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, -1, -1, -1, -1, -1,
-            /* 60 */ -1, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 37, 38, 39, 40,
-            /* 70 */ 41, 42, 43, 44, 45, 46, 47, 48, 49, 50, 51, -1, -1, -1, -1, -1,
-            /* 80 */ -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
-            /* 90 */ -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
-            /* A0 */ -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
-            /* B0 */ -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
-            /* C0 */ -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
-            /* D0 */ -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
-            /* E0 */ -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
-            /* F0 */ -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
-        };
-        static_assert(sizeof(b64_values) / sizeof(int) == 0x100, "Missing base64 values");
+        auto sp = static_cast<const unsigned char *>(data);
+        b64_encode_groups(output, sp, size, url);
+        b64_encode_tail(output, sp, size, url, pad);
+    }
 
-        ST_ssize_t decode_size = b64_decode_size(base64.size(), base64.c_str());
+    // Decode complete groups of four base64 characters.  Returns false
+    // at the first group containing any other character, with sp and
+    // output pointing to that group.
+    inline bool b64_decode_groups(char *&output, const unsigned char *&sp,
+                                  size_t count, bool url) noexcept
+    {
+#if defined(_ST_CODECS_SSSE3)
+        b64_decode_ssse3(output, sp, count, url);
+#endif
+
+        const signed char *b64_values = _ST_PRIVATE::b64_values(url);
+        while (count >= 4) {
+            const int bits[4] = {
+                b64_values[sp[0]], b64_values[sp[1]],
+                b64_values[sp[2]], b64_values[sp[3]]
+            };
+            if ((bits[0] | bits[1] | bits[2] | bits[3]) < 0)
+                return false;
+
+            const unsigned int value = (static_cast<unsigned int>(bits[0]) << 18)
+                                     | (static_cast<unsigned int>(bits[1]) << 12)
+                                     | (static_cast<unsigned int>(bits[2]) << 6)
+                                     | static_cast<unsigned int>(bits[3]);
+            output[0] = static_cast<char>(value >> 16);
+            output[1] = static_cast<char>(value >> 8);
+            output[2] = static_cast<char>(value);
+            output += 3;
+            sp += 4;
+            count -= 4;
+        }
+        return true;
+    }
+
+    inline ST_ssize_t b64_decode(const char *base64, size_t size, void *output,
+                                 size_t output_size, bool url = false,
+                                 bool require_padding = true) noexcept
+    {
+        ST_ssize_t decode_size = b64_decode_size(size, base64, require_padding);
         if (!output)
             return decode_size;
 
@@ -177,47 +472,45 @@ namespace _ST_PRIVATE
             return 0;
 
         char *outp = reinterpret_cast<char *>(output);
-        char *endp = outp + decode_size;
-        auto sp = reinterpret_cast<const unsigned char *>(base64.c_str());
-
-        while (outp + 3 < endp) {
-            int bits[4] = {
-                b64_values[sp[0]], b64_values[sp[1]],
-                b64_values[sp[2]], b64_values[sp[3]]
-            };
-            if (bits[0] < 0 || bits[1] < 0 || bits[2] < 0 || bits[3] < 0)
-                return -1;
-
-            *outp++ = (bits[0] << 2) | ((bits[1] >> 4) & 0x03);
-            *outp++ = ((bits[1] << 4) & 0xF0) | ((bits[2] >> 2) & 0x0F);
-            *outp++ = ((bits[2] << 6) & 0xC0) | (bits[3] & 0x3F);
+        auto sp = reinterpret_cast<const unsigned char *>(base64);
 
-            sp += 4;
-        }
+        // Everything except the final (possibly partial or padded) group
+        const size_t tail_size = (size % 4) ? (size % 4) : 4;
+        if (!b64_decode_groups(outp, sp, size - tail_size, url))
+            return -1;
 
         // Final chars treated specially
-        int bits[4] = {
-            b64_values[sp[0]], b64_values[sp[1]],
-            b64_values[sp[2]], b64_values[sp[3]]
-        };
+        const signed char *b64_values = _ST_PRIVATE::b64_values(url);
+        size_t chars = tail_size;
+        if (chars == 4 && sp[3] == '=') {
+            --chars;
+            if (sp[2] == '=')
+                --chars;
+        }
 
-        if (bits[0] < 0 || bits[1] < 0)
+        int bits[4] = { 0, 0, 0, 0 };
+        for (size_t i = 0; i < chars; ++i) {
+            bits[i] = b64_values[sp[i]];
+            if (bits[i] < 0)
+                return -1;
+        }
+        if (chars < 2)
             return -1;
 
         *outp++ = (bits[0] << 2) | ((bits[1] >> 4) & 0x03);
-        if (sp[2] != '=') {
-            if (bits[2] < 0)
-                return -1;
+        if (chars > 2)
             *outp++ = ((bits[1] << 4) & 0xF0) | ((bits[2] >> 2) & 0x0F);
-        }
-        if (sp[3] != '=') {
-            if (bits[2] < 0 || bits[3] < 0)
-                return -1;
+        if (chars > 3)
             *outp++ = ((bits[2] << 6) & 0xC0) | (bits[3] & 0x3F);
-        }
 
         return outp - reinterpret_cast<char *>(output);
     }
+
+    inline ST_ssize_t b64_decode(const ST::string &base64, void *output,
+                                 size_t output_size) noexcept
+    {
+        return b64_decode(base64.c_str(), base64.size(), output, output_size);
+    }
 }
 
 #endif // _ST_CODECS_PRIV_H
@@ -0,0 +1,139 @@
+/*  Copyright (c) 2026 Michael Hansen
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in
+    all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE. */
+
+#ifndef _ST_CODEPOINTS_H
+#define _ST_CODEPOINTS_H
+
+#include "st_string.h"
+
+#include <vector>
+
+namespace ST
+{
+    // Random access to the code points of a UTF-8 string.  A checkpoint
+    // byte offset is recorded every checkpoint_interval code points the
+    // first time the index is queried, so later lookups only need to scan
+    // from the nearest checkpoint.  ASCII strings need no checkpoints.
+    // The index refers to the string, which must outlive it and must not
+    // be modified while it is in use.  Lookups build the index lazily, so
+    // a single index must not be shared between threads without locking.
+    class code_point_index
+    {
+    public:
+        enum
+        {
+            checkpoint_interval = 64
+        };
+
+        explicit code_point_index(const string &str ST_LIFETIME_BOUND)
+            : m_string(str), m_count(), m_built(), m_ascii() { }
+
+        code_point_index(const code_point_index &) = delete;
+        code_point_index &operator=(const code_point_index &) = delete;
+
+        // Number of code points in the string
+        ST_NODISCARD
+        size_t size() const
+        {
+            build();
+            return m_count;
+        }
+
+        // Byte offset of the code point at index.  An index of size()
+        // returns the size of the string in bytes.
+        ST_NODISCARD
+        size_t byte_offset(size_t index) const
+        {
+            build();
+            if (index > m_count)
+                throw std::out_of_range("Code point index out of range");
+            return offset_of(index);
+        }
+
+        ST_NODISCARD
+        char32_t code_point_at(size_t index) const
+        {
+            build();
+            if (index >= m_count)
+                throw std::out_of_range("Code point index out of range");
+            return _ST_PRIVATE::utf8_decode_at(m_string.c_str(), m_string.size(),
+                                               offset_of(index));
+        }
+
+        // Same clamping behavior as ST::string::substr_code_points
+        ST_NODISCARD
+        string substr_code_points(size_t start, size_t count = ST_AUTO_SIZE) const
+        {
+            build();
+            if (start >= m_count)
+                return string();
+            count = std::min(count, m_count - start);
+
+            const size_t first = offset_of(start);
+            const size_t last = offset_of(start + count);
+            return m_string.substr(static_cast<ST_ssize_t>(first), last - first);
+        }
+
+    private:
+        const string &m_string;
+        mutable std::vector<size_t> m_checkpoints;
+        mutable size_t m_count;
+        mutable bool m_built;
+        mutable bool m_ascii;
+
+        void build() const
+        {
+            if (m_built)
+                return;
+
+            const char *data = m_string.c_str();
+            const size_t size = m_string.size();
+            m_ascii = m_string.is_ascii();
+            if (m_ascii) {
+                m_count = size;
+            } else {
+                m_count = _ST_PRIVATE::utf8_count_code_points(data, size);
+                m_checkpoints.reserve(m_count / checkpoint_interval + 1);
+
+                // Checkpoint k holds the offset of code point k * interval
+                size_t offset = 0;
+                for (size_t cp = 0; cp <= m_count; cp += checkpoint_interval) {
+                    m_checkpoints.push_back(offset);
+                    offset += _ST_PRIVATE::utf8_skip_code_points(data + offset, size - offset,
+                                                                 checkpoint_interval);
+                }
+            }
+            m_built = true;
+        }
+
+        size_t offset_of(size_t index) const noexcept
+        {
+            if (m_ascii)
+                return index;
+
+            const size_t offset = m_checkpoints[index / checkpoint_interval];
+            return offset + _ST_PRIVATE::utf8_skip_code_points(
+                    m_string.c_str() + offset, m_string.size() - offset,
+                    index % checkpoint_interval);
+        }
+    };
+}
+
+#endif // _ST_CODEPOINTS_H
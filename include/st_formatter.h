@@ -308,14 +308,33 @@ namespace ST
             format_type(format, output, value);
         };
     }
+}
+
+namespace _ST_PRIVATE
+{
+    // Used by apply_format, whose arguments outlive the formatters, so
+    // there is no need to copy them (and any heap storage they own) into
+    // the formatter as make_formatter_ref does.
+    template <typename type_T>
+    ST_NODISCARD
+    ST::formatter_ref_t make_formatter_cref(const type_T &value)
+    {
+        return [&value](const ST::format_spec &format, ST::format_writer &output) {
+            format_type(format, output, value);
+        };
+    }
+}
 
+namespace ST
+{
     template <typename arg0_T, typename... args_T>
     void apply_format(ST::format_writer &data, arg0_T &&arg0, args_T &&...args)
     {
+        _ST_TRACE_SCOPE(trace_format, 0);
         enum { num_formatters = 1 + sizeof...(args) };
         formatter_ref_t formatters[num_formatters] = {
-            make_formatter_ref(std::forward<arg0_T>(arg0)),
-            make_formatter_ref(std::forward<args_T>(args))...
+            _ST_PRIVATE::make_formatter_cref(arg0),
+            _ST_PRIVATE::make_formatter_cref(args)...
         };
         size_t index = 0;
         while (data.next_format()) {
@@ -0,0 +1,135 @@
+/*  Copyright (c) 2026 Michael Hansen
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in
+    all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE. */
+
+#ifndef _ST_HASHED_STRING_H
+#define _ST_HASHED_STRING_H
+
+#include "st_string.h"
+
+namespace ST
+{
+    // An ST::string paired with its ST::hash value, computed once on
+    // construction.  Passing a hashed_string to a container using the
+    // transparent ST::hash (e.g. std::unordered_map<ST::string, V, ST::hash,
+    // ST::equal>::find in C++20) skips rehashing the key on each lookup,
+    // which helps when the same key is looked up in several maps.  Equality
+    // between hashed_strings compares the hashes before the string data.
+    class hashed_string
+    {
+    public:
+        hashed_string() noexcept : m_hash(empty_hash()) { }
+
+        hashed_string(const string &str)
+            : m_str(str), m_hash(_ST_PRIVATE::hash_fnv1a(str.c_str(), str.size())) { }
+
+        hashed_string(string &&str) noexcept
+            : m_str(std::move(str)),
+              m_hash(_ST_PRIVATE::hash_fnv1a(m_str.c_str(), m_str.size())) { }
+
+        hashed_string(const hashed_string &) = default;
+        hashed_string &operator=(const hashed_string &) = default;
+
+        // A moved-from hashed_string is empty, so its hash is reset to match
+        hashed_string(hashed_string &&move) noexcept
+            : m_str(std::move(move.m_str)), m_hash(move.m_hash)
+        {
+            move.m_str = string();
+            move.m_hash = empty_hash();
+        }
+
+        hashed_string &operator=(hashed_string &&move) noexcept ST_LIFETIME_BOUND
+        {
+            if (this != &move) {
+                m_str = std::move(move.m_str);
+                m_hash = move.m_hash;
+                move.m_str = string();
+                move.m_hash = empty_hash();
+            }
+            return *this;
+        }
+
+        ST_NODISCARD
+        const string &str() const noexcept ST_LIFETIME_BOUND { return m_str; }
+
+        ST_NODISCARD
+        const char *c_str() const noexcept ST_LIFETIME_BOUND { return m_str.c_str(); }
+
+        ST_NODISCARD
+        size_t size() const noexcept { return m_str.size(); }
+
+        ST_NODISCARD
+        bool empty() const noexcept { return m_str.empty(); }
+
+        ST_NODISCARD
+        size_t hash() const noexcept { return m_hash; }
+
+        operator const string &() const noexcept ST_LIFETIME_BOUND { return m_str; }
+
+        ST_NODISCARD
+        bool operator==(const hashed_string &other) const noexcept
+        {
+            return m_hash == other.m_hash && m_str == other.m_str;
+        }
+
+        ST_NODISCARD
+        bool operator!=(const hashed_string &other) const noexcept
+        {
+            return !operator==(other);
+        }
+
+        ST_NODISCARD
+        bool operator<(const hashed_string &other) const noexcept
+        {
+            return m_str < other.m_str;
+        }
+
+    private:
+        string m_str;
+        size_t m_hash;
+
+        static constexpr size_t empty_hash() noexcept
+        {
+            return _ST_PRIVATE::fnv_constants<size_t>::offset_basis;
+        }
+    };
+
+    static_assert(std::is_standard_layout<ST::hashed_string>::value,
+                  "ST::hashed_string must be standard-layout to pass across the DLL boundary");
+
+    inline size_t hash::operator()(const hashed_string &str) const noexcept
+    {
+        return str.hash();
+    }
+}
+
+namespace std
+{
+    template <>
+    struct hash<ST::hashed_string>
+    {
+        ST_NODISCARD
+        inline size_t operator()(const ST::hashed_string &str) const noexcept
+        {
+            return str.hash();
+        }
+    };
+}
+
+#endif // _ST_HASHED_STRING_H
@@ -0,0 +1,225 @@
+/*  Copyright (c) 2026 Michael Hansen
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in
+    all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE. */
+
+#ifndef _ST_INTERN_POOL_H
+#define _ST_INTERN_POOL_H
+
+#include "st_string.h"
+
+#include <mutex>
+#include <unordered_map>
+#include <memory>
+
+namespace _ST_PRIVATE
+{
+    struct intern_identity_hash
+    {
+        size_t operator()(size_t hash) const noexcept { return hash; }
+    };
+}
+
+namespace ST
+{
+    class intern_pool;
+
+    class interned_string
+    {
+    public:
+        constexpr interned_string() noexcept : m_str() { }
+
+        ST_NODISCARD
+        const string &str() const noexcept ST_LIFETIME_BOUND
+        {
+            return m_str ? *m_str : empty_string();
+        }
+
+        ST_NODISCARD
+        const char *c_str() const noexcept ST_LIFETIME_BOUND
+        {
+            return str().c_str();
+        }
+
+        ST_NODISCARD
+        size_t size() const noexcept { return m_str ? m_str->size() : 0; }
+
+        ST_NODISCARD
+        bool empty() const noexcept { return size() == 0; }
+
+        operator const string &() const noexcept ST_LIFETIME_BOUND { return str(); }
+
+        // Handles from the same pool are equal if and only if they refer
+        // to the same canonical string, so these never touch the string data
+        ST_NODISCARD
+        bool operator==(const interned_string &other) const noexcept
+        {
+            return m_str == other.m_str;
+        }
+
+        ST_NODISCARD
+        bool operator!=(const interned_string &other) const noexcept
+        {
+            return m_str != other.m_str;
+        }
+
+        ST_NODISCARD
+        size_t hash() const noexcept
+        {
+            return std::hash<const string *>()(m_str);
+        }
+
+    private:
+        const string *m_str;
+
+        explicit interned_string(const string *str) noexcept : m_str(str) { }
+
+        static const string &empty_string() noexcept
+        {
+            static const string empty;
+            return empty;
+        }
+
+        friend class intern_pool;
+    };
+
+    static_assert(std::is_standard_layout<ST::interned_string>::value,
+                  "ST::interned_string must be standard-layout to pass across the DLL boundary");
+
+    class intern_pool
+    {
+    public:
+        explicit intern_pool(size_t shard_count = 16)
+            : m_shards(new shard[shard_count ? shard_count : 1]),
+              m_shard_count(shard_count ? shard_count : 1) { }
+
+        intern_pool(const intern_pool &) = delete;
+        intern_pool &operator=(const intern_pool &) = delete;
+
+        ST_NODISCARD
+        interned_string intern(const string &str)
+        {
+            if (str.empty())
+                return interned_string();
+
+            const size_t hash = _ST_PRIVATE::hash_fnv1a(str.c_str(), str.size());
+            shard &bucket = shard_for(hash);
+            std::lock_guard<std::mutex> lock(bucket.m_mutex);
+            const string *found = bucket.find(hash, str.c_str(), str.size());
+            if (!found)
+                found = &bucket.m_strings.emplace(hash, str)->second;
+            return interned_string(found);
+        }
+
+        ST_NODISCARD
+        interned_string intern(string &&str)
+        {
+            if (str.empty())
+                return interned_string();
+
+            const size_t hash = _ST_PRIVATE::hash_fnv1a(str.c_str(), str.size());
+            shard &bucket = shard_for(hash);
+            std::lock_guard<std::mutex> lock(bucket.m_mutex);
+            const string *found = bucket.find(hash, str.c_str(), str.size());
+            if (!found)
+                found = &bucket.m_strings.emplace(hash, std::move(str))->second;
+            return interned_string(found);
+        }
+
+        ST_NODISCARD
+        interned_string intern(const char *utf8, size_t size = ST_AUTO_SIZE,
+                               utf_validation_t validation = ST_DEFAULT_VALIDATION)
+        {
+            if (size == ST_AUTO_SIZE)
+                size = utf8 ? std::char_traits<char>::length(utf8) : 0;
+            if (size == 0)
+                return interned_string();
+
+            // Look up the raw bytes first, so a hit doesn't need to allocate
+            // or validate a temporary string
+            const size_t hash = _ST_PRIVATE::hash_fnv1a(utf8, size);
+            shard &bucket = shard_for(hash);
+            {
+                std::lock_guard<std::mutex> lock(bucket.m_mutex);
+                const string *found = bucket.find(hash, utf8, size);
+                if (found)
+                    return interned_string(found);
+            }
+
+            // Validation may alter (substitute_invalid) or reject the input,
+            // so do it outside of the lock and re-intern the result
+            return intern(string(utf8, size, validation));
+        }
+
+        ST_NODISCARD
+        size_t size() const
+        {
+            size_t count = 0;
+            for (size_t i = 0; i < m_shard_count; ++i) {
+                std::lock_guard<std::mutex> lock(m_shards[i].m_mutex);
+                count += m_shards[i].m_strings.size();
+            }
+            return count;
+        }
+
+    private:
+        struct shard
+        {
+            mutable std::mutex m_mutex;
+            std::unordered_multimap<size_t, string,
+                                    _ST_PRIVATE::intern_identity_hash> m_strings;
+
+            const string *find(size_t hash, const char *data, size_t size) const
+            {
+                auto range = m_strings.equal_range(hash);
+                for (auto iter = range.first; iter != range.second; ++iter) {
+                    const string &candidate = iter->second;
+                    if (_ST_PRIVATE::compare_cs(candidate.c_str(), candidate.size(),
+                                                data, size) == 0)
+                        return &candidate;
+                }
+                return nullptr;
+            }
+        };
+
+        std::unique_ptr<shard[]> m_shards;
+        size_t m_shard_count;
+
+        shard &shard_for(size_t hash) noexcept
+        {
+            // The low bits are the ones consumed by the shard's own buckets,
+            // so pick the shard from the high bits instead
+            return m_shards[(hash >> (sizeof(size_t) * 4)) % m_shard_count];
+        }
+    };
+}
+
+namespace std
+{
+    template <>
+    struct hash<ST::interned_string>
+    {
+        ST_NODISCARD
+        inline size_t operator()(const ST::interned_string &str) const noexcept
+        {
+            return str.hash();
+        }
+    };
+}
+
+#endif // _ST_INTERN_POOL_H
@@ -22,6 +22,7 @@
 #define _ST_IOSTREAM_H
 
 #include "st_string.h"
+#include "st_stringstream.h"
 #include "st_formatter.h"
 
 #include <ostream>
@@ -29,59 +30,114 @@
 
 namespace _ST_PRIVATE
 {
-    template <class char_T, class traits_T>
-    class ostream_format_writer : public ST::format_writer
+    // Find a split point no larger than max_chunk which doesn't break up
+    // a UTF-8 sequence.
+    ST_NODISCARD
+    inline size_t utf8_chunk_size(const char *utf8, size_t size, size_t max_chunk)
     {
-    public:
-        ostream_format_writer(const char *format_str,
-                              std::basic_ostream<char_T, traits_T> &stream)
-            : ST::format_writer(format_str), m_stream(stream) { }
+        if (size <= max_chunk)
+            return size;
 
-        template <class write_char_T>
-        typename std::enable_if<std::is_same<write_char_T, char>::value, void>::type
-        write_data(const char *data, size_t size)
-        {
-            m_stream.write(data, size);
-        }
+        size_t chunk = max_chunk;
+        while (chunk > 0 && (static_cast<unsigned char>(utf8[chunk]) & 0xC0) == 0x80)
+            --chunk;
+        return chunk ? chunk : max_chunk;
+    }
 
-        template <class write_char_T>
-        typename std::enable_if<std::is_same<write_char_T, wchar_t>::value, void>::type
-        write_data(const char *data, size_t size)
-        {
-            ST::wchar_buffer wide = ST::utf8_to_wchar(data, size);
-            m_stream.write(wide.data(), wide.size());
+    inline size_t utf8_transcode_chunk(char16_t *dest, const char *utf8, size_t size)
+    {
+        const size_t count = utf16_measure_from_utf8(utf8, size);
+        raise_conversion_error(utf16_convert_from_utf8(dest, utf8, size,
+                                                       ST_DEFAULT_VALIDATION));
+        return count;
+    }
+
+    inline size_t utf8_transcode_chunk(char32_t *dest, const char *utf8, size_t size)
+    {
+        const size_t count = utf32_measure_from_utf8(utf8, size);
+        raise_conversion_error(utf32_convert_from_utf8(dest, utf8, size,
+                                                       ST_DEFAULT_VALIDATION));
+        return count;
+    }
+
+    template <class traits_T>
+    void ostream_write_utf8(std::basic_ostream<char, traits_T> &stream,
+                            const char *utf8, size_t size)
+    {
+        stream.write(utf8, size);
+    }
+
+    // Wide streams are transcoded through a fixed-size buffer, so writing
+    // a long string doesn't require a converted copy of the whole thing.
+    template <class char_T, class traits_T>
+    void ostream_write_utf8(std::basic_ostream<char_T, traits_T> &stream,
+                            const char *utf8, size_t size)
+    {
+        static_assert(sizeof(char_T) == sizeof(char16_t) || sizeof(char_T) == sizeof(char32_t),
+                      "Unsupported stream character type");
+        typedef typename std::conditional<sizeof(char_T) == sizeof(char16_t),
+                                          char16_t, char32_t>::type unit_T;
+
+        // Transcoding never produces more code units than UTF-8 bytes
+        constexpr size_t max_chunk = 256;
+        unit_T units[max_chunk];
+        while (size) {
+            const size_t chunk = utf8_chunk_size(utf8, size, max_chunk);
+            const size_t count = utf8_transcode_chunk(units, utf8, chunk);
+            stream.write(reinterpret_cast<const char_T *>(units), count);
+            utf8 += chunk;
+            size -= chunk;
         }
+    }
 
-        template <class write_char_T>
-        typename std::enable_if<std::is_same<write_char_T, char16_t>::value, void>::type
-        write_data(const char *data, size_t size)
-        {
-            ST::utf16_buffer utf16 = ST::utf8_to_utf16(data, size);
-            m_stream.write(utf16.data(), utf16.size());
+    template <class char_T, class traits_T>
+    void ostream_fill(std::basic_ostream<char_T, traits_T> &stream,
+                      char_T ch, size_t count)
+    {
+        char_T fill[64];
+        std::char_traits<char_T>::assign(fill, std::min(count, sizeof(fill) / sizeof(char_T)), ch);
+        while (count) {
+            const size_t chunk = std::min(count, sizeof(fill) / sizeof(char_T));
+            stream.write(fill, chunk);
+            count -= chunk;
         }
+    }
 
-        template <class write_char_T>
-        typename std::enable_if<std::is_same<write_char_T, char32_t>::value, void>::type
-        write_data(const char *data, size_t size)
-        {
-            ST::utf32_buffer utf32 = ST::utf8_to_utf32(data, size);
-            m_stream.write(utf32.data(), utf32.size());
+    // The token has already been consumed from the stream, so invalid UTF-8
+    // is reported through failbit rather than by leaving it to be re-read.
+    template <class traits_T>
+    void istream_assign_utf8(std::basic_istream<char, traits_T> &stream,
+                             ST::string &result, const char *utf8, size_t size)
+    {
+        try {
+            result = ST::string::from_utf8(utf8, size);
+        } catch (const ST::unicode_error &) {
+            stream.setstate(std::ios_base::failbit);
         }
+    }
+
+    template <class char_T, class traits_T>
+    class ostream_format_writer : public ST::format_writer
+    {
+    public:
+        ostream_format_writer(const char *format_str,
+                              std::basic_ostream<char_T, traits_T> &stream)
+            : ST::format_writer(format_str), m_stream(stream) { }
 
         ostream_format_writer &append(const char *data, size_t size)
             ST_LIFETIME_BOUND override
         {
-            write_data<char_T>(data, size);
+            ostream_write_utf8(m_stream, data, size);
             return *this;
         }
 
         ostream_format_writer &append_char(char ch, size_t count = 1)
             ST_LIFETIME_BOUND override
         {
-            while (count) {
+            if (count == 1)
                 m_stream.put(char_T(ch));
-                --count;
-            }
+            else
+                ostream_fill(m_stream, char_T(ch), count);
             return *this;
         }
 
@@ -106,11 +162,30 @@ std::basic_ostream<char_T, traits_T> &operator<<(
         std::basic_ostream<char_T, traits_T> &stream ST_LIFETIME_BOUND,
         const ST::string &str)
 {
+    // Padding is only applied by the formatted output path, so unpadded
+    // strings can be written directly from the string's own buffer.
+    if (stream.width() == 0) {
+        _ST_PRIVATE::ostream_write_utf8(stream, str.c_str(), str.size());
+        return stream;
+    }
+
     ST::buffer<char_T> buffer;
     str.to_buffer(buffer);
     return stream << std::basic_string<char_T, traits_T>(buffer.data(), buffer.size());
 }
 
+template <class traits_T>
+std::basic_ostream<char, traits_T> &operator<<(
+        std::basic_ostream<char, traits_T> &stream ST_LIFETIME_BOUND,
+        const ST::string &str)
+{
+    if (stream.width() == 0) {
+        stream.write(str.c_str(), str.size());
+        return stream;
+    }
+    return stream << std::basic_string<char, traits_T>(str.c_str(), str.size());
+}
+
 template <class char_T, class traits_T>
 std::basic_istream<char_T, traits_T> &operator>>(
         std::basic_istream<char_T, traits_T> &stream ST_LIFETIME_BOUND,
@@ -122,4 +197,51 @@ std::basic_istream<char_T, traits_T> &operator>>(
     return stream;
 }
 
+// Narrow streams use the standard extractor, which scans the stream buffer
+// in bulk, and convert the token only once it has been consumed.
+template <class traits_T>
+std::basic_istream<char, traits_T> &operator>>(
+        std::basic_istream<char, traits_T> &stream ST_LIFETIME_BOUND,
+        ST::string &str)
+{
+    std::basic_string<char, traits_T> stl_string;
+    if (stream >> stl_string)
+        _ST_PRIVATE::istream_assign_utf8(stream, str, stl_string.c_str(), stl_string.size());
+    return stream;
+}
+
+namespace ST
+{
+    template <class char_T, class traits_T>
+    std::basic_istream<char_T, traits_T> &getline(
+            std::basic_istream<char_T, traits_T> &stream ST_LIFETIME_BOUND,
+            ST::string &str, char_T delim)
+    {
+        std::basic_string<char_T, traits_T> stl_string;
+        std::getline(stream, stl_string, delim);
+        if (!stream.fail())
+            str.set(stl_string.c_str(), stl_string.size());
+        return stream;
+    }
+
+    template <class traits_T>
+    std::basic_istream<char, traits_T> &getline(
+            std::basic_istream<char, traits_T> &stream ST_LIFETIME_BOUND,
+            ST::string &str, char delim)
+    {
+        std::basic_string<char, traits_T> stl_string;
+        if (std::getline(stream, stl_string, delim))
+            _ST_PRIVATE::istream_assign_utf8(stream, str, stl_string.c_str(), stl_string.size());
+        return stream;
+    }
+
+    template <class char_T, class traits_T>
+    std::basic_istream<char_T, traits_T> &getline(
+            std::basic_istream<char_T, traits_T> &stream ST_LIFETIME_BOUND,
+            ST::string &str)
+    {
+        return getline(stream, str, stream.widen('\n'));
+    }
+}
+
 #endif // _ST_IOSTREAM_H
@@ -0,0 +1,190 @@
+/*  Copyright (c) 2026 Michael Hansen
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in
+    all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE. */
+
+#ifndef _ST_KEYWORD_MAP_H
+#define _ST_KEYWORD_MAP_H
+
+#include "st_string.h"
+
+#include <stdexcept>
+
+namespace ST
+{
+    // Maps each of a fixed list of keywords to its index in that list,
+    // using a perfect hash built when the map is constructed.  A lookup is
+    // one ST::hash of the key, one table probe and one comparison, rather
+    // than a comparison against each keyword in turn.  The keyword strings
+    // are not copied, so they must outlive the map (string literals are
+    // the intended use), and the map itself is best constructed once, e.g.
+    // as a function-local static.
+    //
+    //     static const ST::keyword_map<3> methods({ "GET", "PUT", "POST" });
+    //     switch (methods.find(request.method())) { ... }
+    template <size_t count>
+    class keyword_map
+    {
+        static_assert(count > 0, "keyword_map requires at least one keyword");
+
+    public:
+        enum
+        {
+            bucket_count = _ST_PRIVATE::next_power_of_2(count),
+            table_size = bucket_count * 2
+        };
+
+        explicit keyword_map(const char *const (&keywords)[count])
+            : m_slots(), m_seeds()
+        {
+            size_t hashes[count];
+            for (size_t i = 0; i < count; ++i) {
+                m_keywords[i] = keywords[i] ? keywords[i] : "";
+                m_sizes[i] = std::char_traits<char>::length(m_keywords[i]);
+                hashes[i] = _ST_PRIVATE::hash_fnv1a(m_keywords[i], m_sizes[i]);
+                for (size_t j = 0; j < i; ++j) {
+                    if (m_sizes[j] == m_sizes[i]
+                            && _ST_PRIVATE::compare_cs(m_keywords[j], m_keywords[i], m_sizes[i]) == 0)
+                        throw std::invalid_argument("Duplicate keyword passed to keyword_map");
+                }
+            }
+
+            // Place the fullest buckets first, while the table is emptiest,
+            // choosing for each bucket a seed that moves all of its
+            // keywords into free slots
+            size_t bucket_sizes[bucket_count] = {};
+            for (size_t i = 0; i < count; ++i)
+                ++bucket_sizes[bucket_for(hashes[i])];
+
+            size_t members[count];
+            for (size_t placed = 0; placed < count; ) {
+                size_t bucket = 0;
+                for (size_t b = 1; b < bucket_count; ++b) {
+                    if (bucket_sizes[b] > bucket_sizes[bucket])
+                        bucket = b;
+                }
+
+                size_t member_count = 0;
+                for (size_t i = 0; i < count; ++i) {
+                    if (bucket_for(hashes[i]) == bucket)
+                        members[member_count++] = i;
+                }
+
+                m_seeds[bucket] = find_seed(hashes, members, member_count);
+                for (size_t m = 0; m < member_count; ++m)
+                    m_slots[slot_for(hashes[members[m]], m_seeds[bucket])] = members[m] + 1;
+
+                placed += member_count;
+                bucket_sizes[bucket] = 0;
+            }
+        }
+
+        // Returns the index of key in the keyword list, or -1 if key is
+        // not one of the keywords
+        ST_NODISCARD
+        ST_ssize_t find(const char *key, size_t size) const noexcept
+        {
+            const size_t hash = _ST_PRIVATE::hash_fnv1a(key, size);
+            const size_t slot = m_slots[slot_for(hash, m_seeds[bucket_for(hash)])];
+            if (slot == 0)
+                return -1;
+
+            const size_t index = slot - 1;
+            if (m_sizes[index] != size
+                    || _ST_PRIVATE::compare_cs(m_keywords[index], key, size) != 0)
+                return -1;
+            return static_cast<ST_ssize_t>(index);
+        }
+
+        template <typename key_T>
+        ST_NODISCARD
+        _ST_PRIVATE::enable_lookup_t<key_T, key_T, ST_ssize_t>
+        find(const key_T &key) const noexcept
+        {
+            const _ST_PRIVATE::lookup_key lookup(key);
+            return find(lookup.data, lookup.size);
+        }
+
+        ST_NODISCARD
+        size_t size() const noexcept { return count; }
+
+        ST_NODISCARD
+        const char *keyword(size_t index) const
+        {
+            if (index >= count)
+                throw std::out_of_range("Keyword index out of range");
+            return m_keywords[index];
+        }
+
+    private:
+        const char *m_keywords[count];
+        size_t m_sizes[count];
+        size_t m_slots[table_size];     // Keyword index + 1, or 0 if free
+        size_t m_seeds[bucket_count];
+
+        static size_t mix(size_t value) noexcept
+        {
+            // splitmix64 style finalizer (truncated on 32-bit platforms).
+            // FNV-1a alone spreads similar keywords poorly.
+            value ^= value >> (sizeof(size_t) * 4);
+            value *= static_cast<size_t>(0xbf58476d1ce4e5b9ULL);
+            value ^= value >> (sizeof(size_t) * 4);
+            return value;
+        }
+
+        static size_t bucket_for(size_t hash) noexcept
+        {
+            return (mix(hash) >> (sizeof(size_t) * 4)) & (bucket_count - 1);
+        }
+
+        static size_t slot_for(size_t hash, size_t seed) noexcept
+        {
+            return mix(hash + seed * static_cast<size_t>(0x9e3779b97f4a7c15ULL))
+                    & (table_size - 1);
+        }
+
+        size_t find_seed(const size_t *hashes, const size_t *members,
+                         size_t member_count) const
+        {
+            // With the table at most half full, a bucket of a few keywords
+            // finds free slots within a handful of seeds.  Only keywords
+            // whose full hashes collide can never be separated.
+            for (size_t seed = 0; seed < 0x10000; ++seed) {
+                bool fits = true;
+                for (size_t m = 0; m < member_count && fits; ++m) {
+                    const size_t slot = slot_for(hashes[members[m]], seed);
+                    if (m_slots[slot] != 0) {
+                        fits = false;
+                        break;
+                    }
+                    for (size_t n = 0; n < m; ++n) {
+                        if (slot_for(hashes[members[n]], seed) == slot) {
+                            fits = false;
+                            break;
+                        }
+                    }
+                }
+                if (fits)
+                    return seed;
+            }
+            throw std::invalid_argument("Keywords passed to keyword_map have colliding hashes");
+        }
+    };
+}
+
+#endif // _ST_KEYWORD_MAP_H
@@ -0,0 +1,187 @@
+/*  Copyright (c) 2026 Michael Hansen
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in
+    all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE. */
+
+#ifndef _ST_LINEREADER_H
+#define _ST_LINEREADER_H
+
+#include "st_string.h"
+
+#include <cstdio>
+#include <cstring>
+
+namespace ST
+{
+    // Reads newline-delimited lines from a FILE* in large blocks.  Each
+    // block is searched with memchr and UTF-8 validated once, and lines are
+    // exposed as views into the block until the next call to next().
+    // The FILE* is not closed by the reader.
+    class line_reader
+    {
+    public:
+        enum
+        {
+            default_block_size = 64 * 1024
+        };
+
+        explicit line_reader(FILE *stream,
+                             utf_validation_t validation = ST_DEFAULT_VALIDATION,
+                             size_t block_size = default_block_size)
+            : m_stream(stream), m_buffer(_ST_PRIVATE::alloc_chars<char>(block_size)),
+              m_alloc(block_size), m_start(), m_end(), m_checked(),
+              m_line(), m_line_size(), m_validation(validation),
+              m_checked_valid(true), m_line_valid(true), m_eof()
+        {
+            ST_ASSERT(stream, "line_reader constructed with NULL stream");
+            ST_ASSERT(block_size > 0, "line_reader block size must be non-zero");
+        }
+
+        line_reader(const line_reader &) = delete;
+        line_reader &operator=(const line_reader &) = delete;
+
+        ~line_reader() noexcept
+        {
+            _ST_PRIVATE::free_chars(m_buffer);
+        }
+
+        // Advance to the next line.  Returns false when the stream is
+        // exhausted.  The line terminator is not included in the line.
+        bool next()
+        {
+            for ( ;; ) {
+                const size_t avail = m_end - m_start;
+                const char *found = static_cast<const char *>(
+                        memchr(m_buffer + m_start, '\n', avail));
+                if (found) {
+                    set_line(m_start, found - (m_buffer + m_start));
+                    m_start += m_line_size + 1;
+                    return true;
+                }
+
+                if (m_eof) {
+                    if (avail == 0)
+                        return false;
+                    set_line(m_start, avail);
+                    m_start = m_end;
+                    return true;
+                }
+
+                fill_buffer();
+            }
+        }
+
+        bool next(string &line)
+        {
+            if (!next())
+                return false;
+            line = to_string();
+            return true;
+        }
+
+        ST_NODISCARD
+        const char *data() const noexcept ST_LIFETIME_BOUND { return m_line; }
+
+        ST_NODISCARD
+        size_t size() const noexcept { return m_line_size; }
+
+#if defined(ST_ENABLE_STL_STRINGS) && defined(ST_HAVE_CXX17_STRING_VIEW)
+        ST_NODISCARD
+        std::string_view view() const noexcept ST_LIFETIME_BOUND
+        {
+            return std::string_view(m_line, m_line_size);
+        }
+#endif
+
+        // Return an owned copy of the current line.  When validation is
+        // substitute_invalid, invalid sequences are only replaced here;
+        // the views above always expose the raw bytes.
+        ST_NODISCARD
+        string to_string() const
+        {
+            if (m_line_valid)
+                return string::from_validated(m_line, m_line_size);
+            return string::from_utf8(m_line, m_line_size, substitute_invalid);
+        }
+
+    private:
+        FILE *m_stream;
+        char *m_buffer;
+        size_t m_alloc, m_start, m_end, m_checked;
+        const char *m_line;
+        size_t m_line_size;
+        utf_validation_t m_validation;
+        bool m_checked_valid, m_line_valid, m_eof;
+
+        void set_line(size_t start, size_t size)
+        {
+            m_line = m_buffer + start;
+            m_line_size = size;
+            m_line_valid = true;
+
+            // If the block failed validation, find out whether this line
+            // is the culprit.
+            if (!m_checked_valid && m_validation != assume_valid) {
+                const auto error = _ST_PRIVATE::validate_utf8(m_line, m_line_size);
+                if (m_validation == check_validity)
+                    _ST_PRIVATE::raise_conversion_error(error);
+                m_line_valid = (error == _ST_PRIVATE::conversion_error_t::success);
+            }
+        }
+
+        void fill_buffer()
+        {
+            // Keep the unconsumed partial line, and grow the buffer if that
+            // already fills it.
+            const size_t partial = m_end - m_start;
+            if (partial == m_alloc) {
+                char *bigger = _ST_PRIVATE::alloc_chars<char>(m_alloc * 2);
+                std::char_traits<char>::copy(bigger, m_buffer + m_start, partial);
+                _ST_PRIVATE::free_chars(m_buffer);
+                m_buffer = bigger;
+                m_alloc *= 2;
+            } else if (m_start != 0) {
+                std::char_traits<char>::move(m_buffer, m_buffer + m_start, partial);
+            }
+            m_checked = (m_checked > m_start) ? m_checked - m_start : 0;
+            m_start = 0;
+            m_end = partial;
+
+            const size_t count = fread(m_buffer + m_end, sizeof(char),
+                                       m_alloc - m_end, m_stream);
+            m_end += count;
+            if (count == 0)
+                m_eof = true;
+
+            // Validate up to the last complete line, since a newline can
+            // never be part of a multi-byte sequence.
+            size_t check_end = m_end;
+            if (!m_eof) {
+                while (check_end > m_checked && m_buffer[check_end - 1] != '\n')
+                    --check_end;
+            }
+            if (check_end > m_checked && m_validation != assume_valid) {
+                m_checked_valid = _ST_PRIVATE::validate_utf8(m_buffer + m_checked,
+                        check_end - m_checked) == _ST_PRIVATE::conversion_error_t::success;
+                m_checked = check_end;
+            }
+        }
+    };
+}
+
+#endif // _ST_LINEREADER_H
@@ -25,16 +25,34 @@
 
 namespace _ST_PRIVATE
 {
+    // Output is staged in a local buffer and written with a single fwrite
+    // per flush, rather than taking the stdio lock for every fragment.
     class stdio_format_writer : public ST::format_writer
     {
     public:
         stdio_format_writer(const char *format_str, FILE *stream)
-            : ST::format_writer(format_str), m_stream(stream) { }
+            : ST::format_writer(format_str), m_stream(stream), m_size() { }
+
+        stdio_format_writer(const stdio_format_writer &) = delete;
+        stdio_format_writer &operator=(const stdio_format_writer &) = delete;
+
+        ~stdio_format_writer() noexcept
+        {
+            flush();
+        }
 
         stdio_format_writer &append(const char *data, size_t size)
             ST_LIFETIME_BOUND override
         {
-            (void)fwrite(data, sizeof(char), size, m_stream);
+            if (m_size + size > sizeof(m_buffer)) {
+                flush();
+                if (size >= sizeof(m_buffer)) {
+                    (void)fwrite(data, sizeof(char), size, m_stream);
+                    return *this;
+                }
+            }
+            std::char_traits<char>::copy(m_buffer + m_size, data, size);
+            m_size += size;
             return *this;
         }
 
@@ -42,14 +60,28 @@ namespace _ST_PRIVATE
             ST_LIFETIME_BOUND override
         {
             while (count) {
-                fputc(ch, m_stream);
-                --count;
+                if (m_size == sizeof(m_buffer))
+                    flush();
+                const size_t fill = std::min(count, sizeof(m_buffer) - m_size);
+                std::char_traits<char>::assign(m_buffer + m_size, fill, ch);
+                m_size += fill;
+                count -= fill;
             }
             return *this;
         }
 
+        void flush() noexcept
+        {
+            if (m_size) {
+                (void)fwrite(m_buffer, sizeof(char), m_size, m_stream);
+                m_size = 0;
+            }
+        }
+
     private:
         FILE *m_stream;
+        size_t m_size;
+        char m_buffer[256];
     };
 }
 
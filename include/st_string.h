@@ -25,6 +25,7 @@
 #include <functional>
 
 #include "st_string_priv.h"
+#include "st_charset.h"
 #include "st_utf_conv.h"
 
 #ifdef ST_HAVE_INT64
@@ -98,7 +99,27 @@ namespace ST
                 return;
             }
 
-            set(char_buffer(utf8, size), validation);
+            switch (validation) {
+            case check_validity:
+            case substitute_invalid:
+            {
+                // Validate while copying, rather than copying and then
+                // validating the copy
+                bool ascii;
+                m_buffer = _ST_PRIVATE::copy_utf8_buffer(utf8, size,
+                                                         validation == substitute_invalid,
+                                                         ascii);
+                m_buffer.set_ascii_hint(ascii);
+                break;
+            }
+
+            case assume_valid:
+                m_buffer = char_buffer(utf8, size);
+                break;
+
+            default:
+                ST_ASSERT(false, "Invalid validation type");
+            }
         }
 
 #ifdef ST_HAVE_CXX20_CHAR8_TYPES
@@ -371,14 +392,15 @@ namespace ST
         {
             switch (validation) {
             case check_validity:
-                _ST_PRIVATE::raise_conversion_error(
-                    _ST_PRIVATE::validate_utf8(init.data(), init.size()));
-                m_buffer = init;
-                break;
-
             case substitute_invalid:
-                m_buffer = _ST_PRIVATE::cleanup_utf8_buffer(init);
+            {
+                bool ascii;
+                m_buffer = _ST_PRIVATE::copy_utf8_buffer(init.data(), init.size(),
+                                                         validation == substitute_invalid,
+                                                         ascii);
+                m_buffer.set_ascii_hint(ascii);
                 break;
+            }
 
             case assume_valid:
                 m_buffer = init;
@@ -394,14 +416,27 @@ namespace ST
         {
             switch (validation) {
             case check_validity:
-                _ST_PRIVATE::raise_conversion_error(
-                    _ST_PRIVATE::validate_utf8(init.data(), init.size()));
-                m_buffer = std::move(init);
-                break;
-
             case substitute_invalid:
-                m_buffer = _ST_PRIVATE::cleanup_utf8_buffer(init);
+            {
+                // The buffer is already ours, so only invalid data needs
+                // a new one
+                _ST_TRACE_SCOPE(trace_validate_utf8, init.size());
+                _ST_PRIVATE::conversion_error_t error;
+                bool ascii;
+                const size_t valid_size = _ST_PRIVATE::valid_utf8_prefix(
+                        init.c_str(), init.size(), error, ascii);
+                if (error == _ST_PRIVATE::conversion_error_t::success) {
+                    m_buffer = std::move(init);
+                    m_buffer.set_ascii_hint(ascii);
+                } else if (validation == check_validity) {
+                    _ST_PRIVATE::raise_conversion_error(error);
+                } else {
+                    m_buffer = _ST_PRIVATE::repair_utf8_buffer(init.c_str(), init.size(),
+                                                               valid_size);
+                    m_buffer.set_ascii_hint(false);
+                }
                 break;
+            }
 
             case assume_valid:
                 m_buffer = std::move(init);
@@ -1058,30 +1093,50 @@ namespace ST
             return m_buffer.crend();
         }
 
+        // Iterates the string by code point, decoding in place
+        ST_NODISCARD
+        code_point_range code_points() const noexcept ST_LIFETIME_BOUND
+        {
+            return code_point_range(c_str(), size());
+        }
+
         ST_NODISCARD
         char_buffer to_utf8() const noexcept { return m_buffer; }
 
+        // Move the UTF-8 data out of this string without copying it.
+        // The string is left empty.
+        ST_NODISCARD
+        char_buffer release_buffer() noexcept { return std::move(m_buffer); }
+
         ST_NODISCARD
         utf16_buffer to_utf16() const
         {
+            if (m_buffer.ascii_hint() == char_buffer::ascii_only)
+                return _ST_PRIVATE::convert_ascii<char16_t>(m_buffer.data(), m_buffer.size());
             return utf8_to_utf16(m_buffer, assume_valid);
         }
 
         ST_NODISCARD
         utf32_buffer to_utf32() const
         {
+            if (m_buffer.ascii_hint() == char_buffer::ascii_only)
+                return _ST_PRIVATE::convert_ascii<char32_t>(m_buffer.data(), m_buffer.size());
             return utf8_to_utf32(m_buffer, assume_valid);
         }
 
         ST_NODISCARD
         wchar_buffer to_wchar() const
         {
+            if (m_buffer.ascii_hint() == char_buffer::ascii_only)
+                return _ST_PRIVATE::convert_ascii<wchar_t>(m_buffer.data(), m_buffer.size());
             return utf8_to_wchar(m_buffer, assume_valid);
         }
 
         ST_NODISCARD
         char_buffer to_latin_1(bool substitute_out_of_range = true) const
         {
+            if (m_buffer.ascii_hint() == char_buffer::ascii_only)
+                return m_buffer;
             return utf8_to_latin_1(m_buffer, assume_valid, substitute_out_of_range);
         }
 
@@ -1234,6 +1289,61 @@ namespace ST
         ST_NODISCARD
         bool empty() const noexcept { return m_buffer.empty(); }
 
+        // Whether the string contains only ASCII characters.  This is
+        // recorded when the string is validated, so it is usually free.
+        ST_NODISCARD
+        bool is_ascii() const noexcept
+        {
+            switch (m_buffer.ascii_hint()) {
+            case char_buffer::ascii_only:
+                return true;
+            case char_buffer::not_ascii:
+                return false;
+            default:
+                return _ST_PRIVATE::is_ascii(m_buffer.data(), m_buffer.size());
+            }
+        }
+
+        // Number of Unicode code points in the string
+        ST_NODISCARD
+        size_t code_point_count() const noexcept
+        {
+            if (m_buffer.ascii_hint() == char_buffer::ascii_only)
+                return size();
+            return _ST_PRIVATE::utf8_count_code_points(c_str(), size());
+        }
+
+        // Code point access by index scans the string from the start unless
+        // it is known to be ASCII.  Use ST::code_point_index for repeated
+        // random access into the same string.
+        ST_NODISCARD
+        char32_t code_point_at(size_t index) const
+        {
+            const size_t offset = (m_buffer.ascii_hint() == char_buffer::ascii_only)
+                                ? index
+                                : _ST_PRIVATE::utf8_skip_code_points(c_str(), size(), index);
+            if (offset >= size())
+                throw std::out_of_range("Code point index out of range");
+            return _ST_PRIVATE::utf8_decode_at(c_str(), size(), offset);
+        }
+
+        ST_NODISCARD
+        string substr_code_points(size_t start, size_t count = ST_AUTO_SIZE) const
+        {
+            if (m_buffer.ascii_hint() == char_buffer::ascii_only) {
+                if (start >= size())
+                    return string();
+                return substr(static_cast<ST_ssize_t>(start), std::min(count, size() - start));
+            }
+
+            const size_t first = _ST_PRIVATE::utf8_skip_code_points(c_str(), size(), start);
+            if (count == ST_AUTO_SIZE)
+                return substr(static_cast<ST_ssize_t>(first));
+            const size_t length = _ST_PRIVATE::utf8_skip_code_points(c_str() + first,
+                                                                     size() - first, count);
+            return substr(static_cast<ST_ssize_t>(first), length);
+        }
+
         ST_NODISCARD
         static string from_int(short value, int base = 10, bool upper_case = false)
         {
@@ -1985,46 +2095,41 @@ namespace ST
         ST_NODISCARD
         string trim_left(const char *charset = ST_WHITESPACE) const
         {
-            if (empty())
-                return string();
-
-            const char *cp = c_str();
-            size_t cssize = std::char_traits<char>::length(charset);
-            while (*cp && _ST_PRIVATE::find_cs(charset, cssize, *cp))
-                ++cp;
+            return trim_left(char_set(charset));
+        }
 
+        ST_NODISCARD
+        string trim_left(const char_set &charset) const
+        {
+            const char *cp = charset.skip(c_str(), c_str() + size());
             return substr(cp - c_str());
         }
 
         ST_NODISCARD
         string trim_right(const char *charset = ST_WHITESPACE) const
         {
-            if (empty())
-                return string();
-
-            const char *cp = c_str() + size();
-            size_t cssize = std::char_traits<char>::length(charset);
-            while (--cp >= c_str() && _ST_PRIVATE::find_cs(charset, cssize, *cp))
-                ;
+            return trim_right(char_set(charset));
+        }
 
-            return substr(0, cp - c_str() + 1);
+        ST_NODISCARD
+        string trim_right(const char_set &charset) const
+        {
+            const char *cp = charset.skip_back(c_str(), c_str() + size());
+            return substr(0, cp - c_str());
         }
 
         ST_NODISCARD
         string trim(const char *charset = ST_WHITESPACE) const
         {
-            if (empty())
-                return string();
-
-            const char *lp = c_str();
-            const char *rp = lp + size();
-            size_t cssize = std::char_traits<char>::length(charset);
-            while (*lp && _ST_PRIVATE::find_cs(charset, cssize, *lp))
-                ++lp;
-            while (--rp >= lp && _ST_PRIVATE::find_cs(charset, cssize, *rp))
-                ;
+            return trim(char_set(charset));
+        }
 
-            return substr(lp - c_str(), rp - lp + 1);
+        ST_NODISCARD
+        string trim(const char_set &charset) const
+        {
+            const char *lp = charset.skip(c_str(), c_str() + size());
+            const char *rp = charset.skip_back(lp, c_str() + size());
+            return substr(lp - c_str(), rp - lp);
         }
 
         ST_NODISCARD
@@ -2301,6 +2406,7 @@ namespace ST
         string replace(const string &from, const string &to,
                        case_sensitivity_t cs = case_sensitive) const
         {
+            _ST_TRACE_SCOPE(trace_replace, size());
             if (empty() || from.empty())
                 return *this;
 
@@ -2516,24 +2622,25 @@ namespace ST
 
         ST_NODISCARD
         std::vector<string> tokenize(const char *delims = ST_WHITESPACE) const
+        {
+            return tokenize(char_set(delims));
+        }
+
+        ST_NODISCARD
+        std::vector<string> tokenize(const char_set &delims) const
         {
             std::vector<string> result;
 
             const char *next = c_str();
             const char *endp = next + size();
-            size_t dsize = std::char_traits<char>::length(delims);
             while (next != endp) {
-                const char *cur = next;
-                while (cur != endp && !_ST_PRIVATE::find_cs(delims, dsize, *cur))
-                    ++cur;
+                const char *cur = delims.find(next, endp);
 
                 // Found a delimiter
                 if (cur != next)
                     result.emplace_back(string::from_validated(next, cur - next));
 
-                next = cur;
-                while (next != endp && _ST_PRIVATE::find_cs(delims, dsize, *next))
-                    ++next;
+                next = delims.skip(cur, endp);
             }
 
             return result;
@@ -2550,60 +2657,394 @@ namespace ST
     static_assert(std::is_standard_layout<ST::string>::value,
                   "ST::string must be standard-layout to pass across the DLL boundary");
 
+}
+
+namespace _ST_PRIVATE
+{
+    // A borrowed key for the transparent hash and comparison functors, so
+    // a C string or view can be used to probe a container of ST::strings
+    // without building (and validating) an ST::string first.  Keys are
+    // hashed and compared as raw bytes.
+    struct lookup_key
+    {
+        const char *data;
+        size_t size;
+
+        lookup_key(const ST::string &str) noexcept
+            : data(str.c_str()), size(str.size()) { }
+
+        lookup_key(const char *str) noexcept
+            : data(str ? str : ""), size(str ? std::char_traits<char>::length(str) : 0) { }
+
+#ifdef ST_HAVE_CXX20_CHAR8_TYPES
+        lookup_key(const char8_t *str) noexcept
+            : lookup_key(reinterpret_cast<const char *>(str)) { }
+#endif
+
+#if defined(ST_ENABLE_STL_STRINGS)
+        lookup_key(const std::string &str) noexcept
+            : data(str.c_str()), size(str.size()) { }
+
+#if defined(ST_HAVE_CXX17_STRING_VIEW)
+        lookup_key(const std::string_view &view) noexcept
+            : data(view.data()), size(view.size()) { }
+#endif
+#endif
+    };
+
+    template <typename key_T>
+    struct is_lookup_key : std::false_type { };
+
+    template <> struct is_lookup_key<ST::string> : std::true_type { };
+    template <> struct is_lookup_key<const char *> : std::true_type { };
+    template <> struct is_lookup_key<char *> : std::true_type { };
+
+#ifdef ST_HAVE_CXX20_CHAR8_TYPES
+    template <> struct is_lookup_key<const char8_t *> : std::true_type { };
+    template <> struct is_lookup_key<char8_t *> : std::true_type { };
+#endif
+
+#if defined(ST_ENABLE_STL_STRINGS)
+    template <> struct is_lookup_key<std::string> : std::true_type { };
+
+#if defined(ST_HAVE_CXX17_STRING_VIEW)
+    template <> struct is_lookup_key<std::string_view> : std::true_type { };
+#endif
+#endif
+
+    template <typename left_T, typename right_T, typename result_T>
+    using enable_lookup_t = typename std::enable_if<
+            is_lookup_key<typename std::decay<left_T>::type>::value
+            && is_lookup_key<typename std::decay<right_T>::type>::value, result_T>::type;
+}
+
+namespace ST
+{
+    class hashed_string;
+
+    // The hash and comparison functors below are transparent: in addition
+    // to ST::string, they accept C strings, std::string and
+    // std::string_view keys, which allows heterogeneous lookup (e.g.
+    // std::map::find, or std::unordered_map::find in C++20) without
+    // constructing an ST::string for the probe.
     struct hash
     {
+        typedef void is_transparent;
+
         ST_NODISCARD
         size_t operator()(const string &str) const noexcept
         {
-            /* FNV-1a hash.  See http://isthe.com/chongo/tech/comp/fnv/ for details */
-            size_t hash = _ST_PRIVATE::fnv_constants<size_t>::offset_basis;
-            const char *cp = str.c_str();
-            const char *ep = cp + str.size();
-            while (cp < ep) {
-                hash ^= static_cast<size_t>(*cp++);
-                hash *= _ST_PRIVATE::fnv_constants<size_t>::prime;
-            }
-            return hash;
+            return _ST_PRIVATE::hash_fnv1a(str.c_str(), str.size());
+        }
+
+        // Returns the cached hash; defined in st_hashed_string.h
+        ST_NODISCARD
+        size_t operator()(const hashed_string &str) const noexcept;
+
+        template <typename key_T>
+        ST_NODISCARD
+        _ST_PRIVATE::enable_lookup_t<key_T, key_T, size_t>
+        operator()(const key_T &key) const noexcept
+        {
+            const _ST_PRIVATE::lookup_key lookup(key);
+            return _ST_PRIVATE::hash_fnv1a(lookup.data, lookup.size);
         }
     };
 
+    // The ST::hash of a string literal, usable in constant expressions.
+    // This allows switching on ST::hash()(str) with hash_literal("...")
+    // case labels, although the matched case must still compare str,
+    // since different strings may share a hash.
+    template <size_t size>
+    ST_NODISCARD
+    constexpr size_t hash_literal(const char (&text)[size]) noexcept
+    {
+        return _ST_PRIVATE::hash_fnv1a_constexpr(text, size - 1);
+    }
+
     struct hash_i
     {
+        typedef void is_transparent;
+
         ST_NODISCARD
         size_t operator()(const string &str) const noexcept
         {
-            /* FNV-1a hash.  See http://isthe.com/chongo/tech/comp/fnv/ for details */
-            size_t hash = _ST_PRIVATE::fnv_constants<size_t>::offset_basis;
-            const char *cp = str.c_str();
-            const char *ep = cp + str.size();
-            while (cp < ep) {
-                hash ^= static_cast<size_t>(_ST_PRIVATE::cl_fast_lower(*cp++));
-                hash *= _ST_PRIVATE::fnv_constants<size_t>::prime;
-            }
-            return hash;
+            return _ST_PRIVATE::hash_fnv1a_i(str.c_str(), str.size());
+        }
+
+        template <typename key_T>
+        ST_NODISCARD
+        _ST_PRIVATE::enable_lookup_t<key_T, key_T, size_t>
+        operator()(const key_T &key) const noexcept
+        {
+            const _ST_PRIVATE::lookup_key lookup(key);
+            return _ST_PRIVATE::hash_fnv1a_i(lookup.data, lookup.size);
+        }
+    };
+
+    struct less
+    {
+        typedef void is_transparent;
+
+        ST_NODISCARD
+        bool operator()(const string &left, const string &right)
+            const noexcept
+        {
+            return left.compare(right) < 0;
+        }
+
+        template <typename left_T, typename right_T>
+        ST_NODISCARD
+        _ST_PRIVATE::enable_lookup_t<left_T, right_T, bool>
+        operator()(const left_T &left, const right_T &right) const noexcept
+        {
+            const _ST_PRIVATE::lookup_key lkey(left), rkey(right);
+            return _ST_PRIVATE::compare_cs(lkey.data, lkey.size, rkey.data, rkey.size) < 0;
         }
     };
 
     struct less_i
     {
+        typedef void is_transparent;
+
         ST_NODISCARD
         bool operator()(const string &left, const string &right)
             const noexcept
         {
             return left.compare_i(right) < 0;
         }
+
+        template <typename left_T, typename right_T>
+        ST_NODISCARD
+        _ST_PRIVATE::enable_lookup_t<left_T, right_T, bool>
+        operator()(const left_T &left, const right_T &right) const noexcept
+        {
+            const _ST_PRIVATE::lookup_key lkey(left), rkey(right);
+            return _ST_PRIVATE::compare_ci(lkey.data, lkey.size, rkey.data, rkey.size) < 0;
+        }
+    };
+
+    struct equal
+    {
+        typedef void is_transparent;
+
+        ST_NODISCARD
+        bool operator()(const string &left, const string &right)
+            const noexcept
+        {
+            return left == right;
+        }
+
+        template <typename left_T, typename right_T>
+        ST_NODISCARD
+        _ST_PRIVATE::enable_lookup_t<left_T, right_T, bool>
+        operator()(const left_T &left, const right_T &right) const noexcept
+        {
+            const _ST_PRIVATE::lookup_key lkey(left), rkey(right);
+            return lkey.size == rkey.size
+                    && _ST_PRIVATE::compare_cs(lkey.data, rkey.data, lkey.size) == 0;
+        }
     };
 
     struct equal_i
     {
+        typedef void is_transparent;
+
         ST_NODISCARD
         bool operator()(const string &left, const string &right)
             const noexcept
         {
             return left.compare_i(right) == 0;
         }
+
+        template <typename left_T, typename right_T>
+        ST_NODISCARD
+        _ST_PRIVATE::enable_lookup_t<left_T, right_T, bool>
+        operator()(const left_T &left, const right_T &right) const noexcept
+        {
+            const _ST_PRIVATE::lookup_key lkey(left), rkey(right);
+            return lkey.size == rkey.size
+                    && _ST_PRIVATE::compare_ci(lkey.data, rkey.data, lkey.size) == 0;
+        }
+    };
+}
+
+namespace _ST_PRIVATE
+{
+    // One operand of ST::concat.  ST::string and valid UTF-8 C strings are
+    // referenced; anything else is converted to an owned UTF-8 string.
+    class concat_part
+    {
+    public:
+        concat_part(const char *utf8, size_t size) noexcept
+            : m_data(utf8), m_size(size) { }
+
+        explicit concat_part(ST::string &&owned) noexcept
+            : m_owned(std::move(owned)), m_data(), m_size(m_owned.size()) { }
+
+        ST_NODISCARD
+        size_t size() const noexcept { return m_size; }
+
+        void write(char *&output) const noexcept
+        {
+            std::char_traits<char>::copy(output, data(), m_size);
+            output += m_size;
+        }
+
+    private:
+        ST::string m_owned;
+        const char *m_data;
+        size_t m_size;
+
+        const char *data() const noexcept { return m_data ? m_data : m_owned.c_str(); }
     };
 
+    ST_NODISCARD
+    inline concat_part make_concat_part(const ST::string &str) noexcept
+    {
+        return concat_part(str.c_str(), str.size());
+    }
+
+    ST_NODISCARD
+    inline concat_part make_concat_part(const char *cstr)
+    {
+        if (!cstr)
+            return concat_part("", 0);
+
+        const size_t size = std::char_traits<char>::length(cstr);
+        if (ST_DEFAULT_VALIDATION == ST::assume_valid
+                || validate_utf8(cstr, size) == conversion_error_t::success)
+            return concat_part(cstr, size);
+        return concat_part(ST::string::from_utf8(cstr, size));
+    }
+
+    ST_NODISCARD
+    inline concat_part make_concat_part(const wchar_t *wstr)
+    {
+        return concat_part(ST::string::from_wchar(wstr));
+    }
+
+    ST_NODISCARD
+    inline concat_part make_concat_part(const char16_t *cstr)
+    {
+        return concat_part(ST::string::from_utf16(cstr));
+    }
+
+    ST_NODISCARD
+    inline concat_part make_concat_part(const char32_t *cstr)
+    {
+        return concat_part(ST::string::from_utf32(cstr));
+    }
+
+#ifdef ST_HAVE_CXX20_CHAR8_TYPES
+    ST_NODISCARD
+    inline concat_part make_concat_part(const char8_t *cstr)
+    {
+        return make_concat_part(reinterpret_cast<const char *>(cstr));
+    }
+#endif
+
+    ST_NODISCARD
+    inline concat_part make_concat_part(char32_t ch)
+    {
+        char utf8[4];
+        char *dest = utf8;
+        raise_conversion_error(write_utf8(dest, ch));
+        return concat_part(ST::string::from_validated(utf8, dest - utf8));
+    }
+
+    ST_NODISCARD
+    inline concat_part make_concat_part(char16_t ch)
+    {
+        return make_concat_part(static_cast<char32_t>(ch));
+    }
+
+    ST_NODISCARD
+    inline concat_part make_concat_part(char ch)
+    {
+        return make_concat_part(static_cast<char32_t>(static_cast<unsigned char>(ch)));
+    }
+
+    ST_NODISCARD
+    inline concat_part make_concat_part(wchar_t ch)
+    {
+        return make_concat_part(static_cast<char32_t>(static_cast<unsigned int>(ch)));
+    }
+
+    inline size_t concat_size() noexcept { return 0; }
+
+    template <typename... parts_T>
+    size_t concat_size(const concat_part &first, const parts_T &... rest) noexcept
+    {
+        return first.size() + concat_size(rest...);
+    }
+
+    inline void concat_write(char *&) noexcept { }
+
+    template <typename... parts_T>
+    void concat_write(char *&output, const concat_part &first,
+                      const parts_T &... rest) noexcept
+    {
+        first.write(output);
+        concat_write(output, rest...);
+    }
+
+    template <typename... parts_T>
+    ST_NODISCARD
+    ST::string concat_parts(const parts_T &... parts)
+    {
+        ST::char_buffer result;
+        result.allocate(concat_size(parts...));
+        char *output = result.data();
+        concat_write(output, parts...);
+        return ST::string::from_validated(std::move(result));
+    }
+
+    // Item types accepted by ST::join.  std::string_view items are not
+    // known to be valid UTF-8, so the joined result is validated once.
+    ST_NODISCARD
+    inline const char *join_data(const ST::string &item) noexcept
+    {
+        return item.c_str();
+    }
+
+    ST_NODISCARD
+    inline ST::string join_result(ST::char_buffer &&buffer, const ST::string *)
+    {
+        return ST::string::from_validated(std::move(buffer));
+    }
+
+#if defined(ST_ENABLE_STL_STRINGS) && defined(ST_HAVE_CXX17_STRING_VIEW)
+    ST_NODISCARD
+    inline const char *join_data(const std::string_view &item) noexcept
+    {
+        return item.data();
+    }
+
+    ST_NODISCARD
+    inline ST::string join_result(ST::char_buffer &&buffer, const std::string_view *)
+    {
+        return ST::string(std::move(buffer), ST_DEFAULT_VALIDATION);
+    }
+#endif
+
+    // Total size of the items in range plus a separator between each pair
+    template <typename range_T>
+    ST_NODISCARD
+    size_t join_size(const range_T &items, size_t separator_size) noexcept
+    {
+        size_t count = 0;
+        size_t total = 0;
+        for (const auto &item : items) {
+            total += item.size();
+            ++count;
+        }
+        return count ? total + separator_size * (count - 1) : 0;
+    }
+}
+
+namespace ST
+{
     ST_NODISCARD
     inline string operator+(const string &left, const string &right)
     {
@@ -2753,6 +3194,45 @@ namespace ST
         return operator+(uchar, right);
     }
 
+    // Concatenates any number of the operands accepted by operator+ --
+    // strings, C strings and characters -- into one exactly sized buffer.
+    // Unlike a chain of operator+, no intermediate strings are built.
+    template <typename... args_T>
+    ST_NODISCARD
+    string concat(const args_T &... args)
+    {
+        return _ST_PRIVATE::concat_parts(_ST_PRIVATE::make_concat_part(args)...);
+    }
+
+    // Joins a forward range of strings with separator.  The result is
+    // sized exactly and allocated once.  ST::string items are already
+    // valid, so they are copied without validation.
+    template <typename range_T>
+    ST_NODISCARD
+    string join(const range_T &items, const string &separator)
+    {
+        typedef typename std::decay<decltype(*std::begin(items))>::type item_T;
+
+        const size_t total = _ST_PRIVATE::join_size(items, separator.size());
+        if (total == 0)
+            return string();
+
+        char_buffer result;
+        result.allocate(total);
+        char *output = result.data();
+        bool first = true;
+        for (const auto &item : items) {
+            if (!first) {
+                std::char_traits<char>::copy(output, separator.c_str(), separator.size());
+                output += separator.size();
+            }
+            first = false;
+            std::char_traits<char>::copy(output, _ST_PRIVATE::join_data(item), item.size());
+            output += item.size();
+        }
+        return _ST_PRIVATE::join_result(std::move(result), static_cast<const item_T *>(nullptr));
+    }
+
     ST_NODISCARD
     ST_DEPRECATED_IN_3_4("Use string::empty() instead")
     inline bool operator==(const null_t &, const string &right) noexcept
@@ -213,6 +213,51 @@ namespace _ST_PRIVATE
         static constexpr SizeType offset_basis = 0xcbf29ce484222325ULL;
         static constexpr SizeType prime = 0x00000100000001b3ULL;
     };
+
+    ST_NODISCARD
+    inline size_t hash_fnv1a(const char *data, size_t size) noexcept
+    {
+        /* FNV-1a hash.  See http://isthe.com/chongo/tech/comp/fnv/ for details */
+        size_t hash = fnv_constants<size_t>::offset_basis;
+        const char *cp = data;
+        const char *ep = cp + size;
+        while (cp < ep) {
+            hash ^= static_cast<size_t>(*cp++);
+            hash *= fnv_constants<size_t>::prime;
+        }
+        return hash;
+    }
+
+    // hash_fnv1a in C++11 constexpr form, for hashing literals at compile
+    // time.  Each byte is one level of recursion, so this is only intended
+    // for short strings.
+    ST_NODISCARD
+    constexpr size_t hash_fnv1a_constexpr(const char *data, size_t size,
+            size_t hash = fnv_constants<size_t>::offset_basis) noexcept
+    {
+        return size ? hash_fnv1a_constexpr(data + 1, size - 1,
+                        (hash ^ static_cast<size_t>(*data)) * fnv_constants<size_t>::prime)
+                    : hash;
+    }
+
+    ST_NODISCARD
+    constexpr size_t next_power_of_2(size_t value, size_t result = 1) noexcept
+    {
+        return result >= value ? result : next_power_of_2(value, result * 2);
+    }
+
+    ST_NODISCARD
+    inline size_t hash_fnv1a_i(const char *data, size_t size) noexcept
+    {
+        size_t hash = fnv_constants<size_t>::offset_basis;
+        const char *cp = data;
+        const char *ep = cp + size;
+        while (cp < ep) {
+            hash ^= static_cast<size_t>(cl_fast_lower(*cp++));
+            hash *= fnv_constants<size_t>::prime;
+        }
+        return hash;
+    }
 }
 
 #endif // _ST_STRING_PRIV_H
@@ -0,0 +1,346 @@
+/*  Copyright (c) 2026 Michael Hansen
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in
+    all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE. */
+
+#ifndef _ST_STRINGBUILDER_H
+#define _ST_STRINGBUILDER_H
+
+#include "st_string.h"
+
+#include <cstdio>
+#include <cstdint>
+#include <iosfwd>
+#include <memory>
+
+namespace _ST_PRIVATE
+{
+    // One chunk of an ST::string_builder.  The chunks form a treap ordered
+    // by position, with each node caching the byte and chunk totals of its
+    // subtree, so a position can be found -- and a builder split or joined
+    // there -- in O(log n) expected time.
+    struct rope_node
+    {
+        ST::string chunk;
+        size_t size;
+        size_t count;
+        size_t priority;
+        std::unique_ptr<rope_node> left, right;
+
+        explicit rope_node(ST::string &&str)
+            : chunk(std::move(str)), size(chunk.size()), count(1),
+              priority(mix(reinterpret_cast<uintptr_t>(this)))
+        { }
+
+        // Copies the chunk and totals only; rope_clone() adds the children
+        explicit rope_node(const rope_node &copy)
+            : chunk(copy.chunk), size(copy.size), count(copy.count),
+              priority(copy.priority)
+        { }
+
+        void update() noexcept
+        {
+            size = chunk.size();
+            count = 1;
+            if (left) {
+                size += left->size;
+                count += left->count;
+            }
+            if (right) {
+                size += right->size;
+                count += right->count;
+            }
+        }
+
+        // The splitmix64 finalizer turns the node's heap address into a
+        // well spread priority, without any generator state to carry.
+        static size_t mix(uint64_t value) noexcept
+        {
+            value ^= value >> 30;
+            value *= 0xbf58476d1ce4e5b9ULL;
+            value ^= value >> 27;
+            value *= 0x94d049bb133111ebULL;
+            value ^= value >> 31;
+            return static_cast<size_t>(value);
+        }
+    };
+
+    typedef std::unique_ptr<rope_node> rope_ptr;
+
+    inline rope_ptr rope_merge(rope_ptr left, rope_ptr right)
+    {
+        if (!left)
+            return right;
+        if (!right)
+            return left;
+
+        if (left->priority > right->priority) {
+            left->right = rope_merge(std::move(left->right), std::move(right));
+            left->update();
+            return left;
+        } else {
+            right->left = rope_merge(std::move(left), std::move(right->left));
+            right->update();
+            return right;
+        }
+    }
+
+    // Returns the node whose chunk contains byte pos, and adjusts pos to be
+    // relative to that chunk.  Returns nullptr if pos is at or past the end.
+    inline const rope_node *rope_find(const rope_node *node, size_t &pos) noexcept
+    {
+        while (node) {
+            const size_t left_size = node->left ? node->left->size : 0;
+            if (pos < left_size) {
+                node = node->left.get();
+            } else if (pos - left_size < node->chunk.size()) {
+                pos -= left_size;
+                return node;
+            } else {
+                pos -= left_size + node->chunk.size();
+                node = node->right.get();
+            }
+        }
+        return nullptr;
+    }
+
+    // Split node into the first pos bytes and the rest.  A chunk straddling
+    // pos is cut in two, so the caller must make sure pos falls on a UTF-8
+    // code point boundary.
+    inline void rope_split(rope_ptr node, size_t pos, rope_ptr &left, rope_ptr &right)
+    {
+        if (!node) {
+            left.reset();
+            right.reset();
+            return;
+        }
+
+        const size_t left_size = node->left ? node->left->size : 0;
+        const size_t chunk_size = node->chunk.size();
+        if (pos <= left_size) {
+            rope_split(std::move(node->left), pos, left, node->left);
+            node->update();
+            right = std::move(node);
+        } else if (pos >= left_size + chunk_size) {
+            rope_split(std::move(node->right), pos - left_size - chunk_size,
+                       node->right, right);
+            node->update();
+            left = std::move(node);
+        } else {
+            const char *text = node->chunk.c_str();
+            const size_t split_pos = pos - left_size;
+            rope_ptr tail(new rope_node(ST::string::from_validated(
+                    text + split_pos, chunk_size - split_pos)));
+            node->chunk = ST::string::from_validated(text, split_pos);
+            right = rope_merge(std::move(tail), std::move(node->right));
+            node->update();
+            left = std::move(node);
+        }
+    }
+
+    inline rope_ptr rope_clone(const rope_node *node)
+    {
+        if (!node)
+            return rope_ptr();
+
+        rope_ptr copy(new rope_node(*node));
+        copy->left = rope_clone(node->left.get());
+        copy->right = rope_clone(node->right.get());
+        copy->update();
+        return copy;
+    }
+
+    template <typename chunk_func_T>
+    void rope_for_each(const rope_node *node, const chunk_func_T &func)
+    {
+        while (node) {
+            rope_for_each(node->left.get(), func);
+            func(node->chunk);
+            node = node->right.get();
+        }
+    }
+}
+
+namespace ST
+{
+    // Assembles a string from many fragments without copying them into a
+    // single growing buffer.  Fragments are kept as a balanced tree of
+    // chunks (moved in where possible), so appending, inserting and joining
+    // builders take O(log n) time in the number of chunks.  The bytes are
+    // only copied once, when the result is flattened with to_string() or
+    // written out to a stream.
+    class string_builder
+    {
+    public:
+        string_builder() noexcept { }
+
+        string_builder(const string_builder &copy)
+            : m_root(_ST_PRIVATE::rope_clone(copy.m_root.get()))
+        { }
+
+        string_builder(string_builder &&move) noexcept = default;
+
+        string_builder &operator=(const string_builder &copy)
+        {
+            if (this != &copy)
+                m_root = _ST_PRIVATE::rope_clone(copy.m_root.get());
+            return *this;
+        }
+
+        string_builder &operator=(string_builder &&move) noexcept = default;
+
+        string_builder &append(const string &str) ST_LIFETIME_BOUND
+        {
+            return append(string(str));
+        }
+
+        string_builder &append(string &&str) ST_LIFETIME_BOUND
+        {
+            if (!str.empty()) {
+                _ST_PRIVATE::rope_ptr node(new _ST_PRIVATE::rope_node(std::move(str)));
+                m_root = _ST_PRIVATE::rope_merge(std::move(m_root), std::move(node));
+            }
+            return *this;
+        }
+
+        string_builder &append(const char *text, size_t size = ST_AUTO_SIZE,
+                               utf_validation_t validation = ST_DEFAULT_VALIDATION)
+            ST_LIFETIME_BOUND
+        {
+            return append(string(text, size, validation));
+        }
+
+        string_builder &append(string_builder &&other) ST_LIFETIME_BOUND
+        {
+            m_root = _ST_PRIVATE::rope_merge(std::move(m_root), std::move(other.m_root));
+            return *this;
+        }
+
+        string_builder &operator<<(const string &str) ST_LIFETIME_BOUND
+        {
+            return append(str);
+        }
+
+        string_builder &operator<<(string &&str) ST_LIFETIME_BOUND
+        {
+            return append(std::move(str));
+        }
+
+        string_builder &operator<<(const char *text) ST_LIFETIME_BOUND
+        {
+            return append(text);
+        }
+
+        // Insert a fragment at the specified byte offset.  Throws
+        // std::out_of_range if pos is past the end, and std::invalid_argument
+        // if it would split a UTF-8 sequence.
+        string_builder &insert(size_t pos, string str) ST_LIFETIME_BOUND
+        {
+            if (pos > size())
+                throw std::out_of_range("string_builder::insert position out of range");
+            size_t offset = pos;
+            const _ST_PRIVATE::rope_node *split = _ST_PRIVATE::rope_find(m_root.get(), offset);
+            if (split && (static_cast<unsigned char>(split->chunk.c_str()[offset]) & 0xC0) == 0x80)
+                throw std::invalid_argument("string_builder::insert position splits a UTF-8 sequence");
+            if (str.empty())
+                return *this;
+
+            _ST_PRIVATE::rope_ptr left, right;
+            _ST_PRIVATE::rope_split(std::move(m_root), pos, left, right);
+            _ST_PRIVATE::rope_ptr node(new _ST_PRIVATE::rope_node(std::move(str)));
+            m_root = _ST_PRIVATE::rope_merge(
+                    _ST_PRIVATE::rope_merge(std::move(left), std::move(node)),
+                    std::move(right));
+            return *this;
+        }
+
+        void clear() noexcept { m_root.reset(); }
+
+        ST_NODISCARD
+        size_t size() const noexcept { return m_root ? m_root->size : 0; }
+
+        ST_NODISCARD
+        bool empty() const noexcept { return !m_root; }
+
+        ST_NODISCARD
+        size_t chunk_count() const noexcept { return m_root ? m_root->count : 0; }
+
+        ST_NODISCARD
+        string to_string() const
+        {
+            if (!m_root)
+                return string();
+            if (m_root->count == 1)
+                return m_root->chunk;
+
+            char_buffer result;
+            result.allocate(m_root->size);
+            char *dest = result.data();
+            _ST_PRIVATE::rope_for_each(m_root.get(), [&dest](const string &chunk) {
+                std::char_traits<char>::copy(dest, chunk.c_str(), chunk.size());
+                dest += chunk.size();
+            });
+            return string::from_validated(std::move(result));
+        }
+
+        // Write the chunks to the stream, coalescing runs of short chunks
+        // so that each write call moves a reasonably sized block.
+        void write_to(FILE *stream) const
+        {
+            write_chunks([stream](const char *data, size_t size) {
+                (void)fwrite(data, sizeof(char), size, stream);
+            });
+        }
+
+        template <class traits_T>
+        void write_to(std::basic_ostream<char, traits_T> &stream) const
+        {
+            write_chunks([&stream](const char *data, size_t size) {
+                stream.write(data, size);
+            });
+        }
+
+    private:
+        _ST_PRIVATE::rope_ptr m_root;
+
+        template <typename write_T>
+        void write_chunks(const write_T &write) const
+        {
+            char gather[256];
+            size_t gathered = 0;
+            _ST_PRIVATE::rope_for_each(m_root.get(), [&](const string &chunk) {
+                if (gathered + chunk.size() > sizeof(gather)) {
+                    if (gathered)
+                        write(gather, gathered);
+                    gathered = 0;
+                }
+                if (chunk.size() >= sizeof(gather)) {
+                    write(chunk.c_str(), chunk.size());
+                } else {
+                    std::char_traits<char>::copy(gather + gathered, chunk.c_str(),
+                                                 chunk.size());
+                    gathered += chunk.size();
+                }
+            });
+            if (gathered)
+                write(gather, gathered);
+        }
+    };
+}
+
+#endif // _ST_STRINGBUILDER_H
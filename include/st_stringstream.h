@@ -30,7 +30,7 @@ namespace ST
     {
     public:
         string_stream() noexcept
-            : m_chars(m_stack), m_alloc(ST_STACK_STRING_SIZE), m_size() { }
+            : m_chars(m_stack), m_alloc(stack_size), m_size() { }
 
         string_stream(const string_stream&) = delete;
         string_stream& operator=(const string_stream&) = delete;
@@ -38,27 +38,26 @@ namespace ST
         ~string_stream() noexcept
         {
             if (is_heap())
-                delete[] m_chars;
+                _ST_PRIVATE::free_chars(m_chars);
         }
 
         string_stream(string_stream &&move) noexcept
             : m_alloc(move.m_alloc), m_size(move.m_size)
         {
-            m_chars = is_heap() ? move.m_chars : m_stack;
-            std::char_traits<char>::copy(m_stack, move.m_stack, ST_STACK_STRING_SIZE);
-            move.m_alloc = 0;
+            take_storage(move);
         }
 
         string_stream &operator=(string_stream &&move) noexcept ST_LIFETIME_BOUND
         {
+            if (this == &move)
+                return *this;
+
             if (is_heap())
-                delete[] m_chars;
+                _ST_PRIVATE::free_chars(m_chars);
 
             m_alloc = move.m_alloc;
             m_size = move.m_size;
-            m_chars = is_heap() ? move.m_chars : m_stack;
-            std::char_traits<char>::copy(m_stack, move.m_stack, ST_STACK_STRING_SIZE);
-            move.m_alloc = 0;
+            take_storage(move);
             return *this;
         }
 
@@ -306,6 +305,42 @@ namespace ST
                 return string::from_latin_1(raw_buffer(), size());
         }
 
+        // Move the stream's contents into a string.  If the data has
+        // outgrown the stack buffer, the heap block is handed to the string
+        // directly instead of being copied.  A block that is mostly unused
+        // (e.g. after reserve() or truncate()) is copied instead, and kept
+        // by the stream for reuse.  The stream is left empty.
+        ST_NODISCARD
+        string take_string(utf_validation_t validation = ST_DEFAULT_VALIDATION)
+        {
+            if (!is_heap() || m_size < m_alloc / 2) {
+                string result = string::from_utf8(m_chars, m_size, validation);
+                m_size = 0;
+                return result;
+            }
+
+            // Make room for the nul terminator expected by ST::string
+            if (m_size == m_alloc)
+                reallocate(m_alloc + 1);
+            m_chars[m_size] = 0;
+
+            char_buffer buffer;
+            buffer.adopt(m_chars, m_size);
+            m_chars = m_stack;
+            m_alloc = stack_size;
+            m_size = 0;
+            return string(std::move(buffer), validation);
+        }
+
+        void reserve(size_t size)
+        {
+            if (size > m_alloc)
+                reallocate(size);
+        }
+
+        ST_NODISCARD
+        size_t capacity() const noexcept { return m_alloc; }
+
         void truncate(size_t size = 0) noexcept
         {
             if (size < m_size)
@@ -321,14 +356,35 @@ namespace ST
         }
 
     private:
+        // A configured size of 0 still keeps one byte, so the buffer has
+        // a capacity to double from
+        static constexpr size_t stack_size = (ST_STRING_STREAM_STACK_SIZE > 0)
+                                           ? ST_STRING_STREAM_STACK_SIZE : 1;
+
         char  *m_chars;
         size_t m_alloc, m_size;
-        char   m_stack[ST_STACK_STRING_SIZE];
+        char   m_stack[stack_size];
+
+        template <typename range_T>
+        friend string_stream &join_to(string_stream &, const range_T &, const string &);
 
         ST_NODISCARD
         bool is_heap() const noexcept
         {
-            return m_alloc > ST_STACK_STRING_SIZE;
+            return m_alloc > stack_size;
+        }
+
+        void take_storage(string_stream &move) noexcept
+        {
+            if (is_heap()) {
+                m_chars = move.m_chars;
+            } else {
+                m_chars = m_stack;
+                std::char_traits<char>::copy(m_stack, move.m_stack, m_size);
+            }
+            move.m_chars = move.m_stack;
+            move.m_alloc = stack_size;
+            move.m_size = 0;
         }
 
         void expand_buffer(size_t added_size)
@@ -339,15 +395,47 @@ namespace ST
                     big_size *= 2;
                 } while (m_size + added_size > big_size);
 
-                char *bigger = new char[big_size];
-                std::char_traits<char>::copy(bigger, m_chars, m_alloc);
-                if (is_heap())
-                    delete[] m_chars;
-                m_chars = bigger;
-                m_alloc = big_size;
+                reallocate(big_size);
             }
         }
+
+        void reallocate(size_t new_alloc)
+        {
+            char *bigger = _ST_PRIVATE::alloc_chars<char>(new_alloc);
+            std::char_traits<char>::copy(bigger, m_chars, m_size);
+            if (is_heap())
+                _ST_PRIVATE::free_chars(m_chars);
+            m_chars = bigger;
+            m_alloc = new_alloc;
+        }
     };
+
+    // Appends a forward range of strings to stream with separator.  The
+    // stream grows at most once, and the items are then copied directly
+    // into its buffer.
+    template <typename range_T>
+    string_stream &join_to(string_stream &stream ST_LIFETIME_BOUND,
+                           const range_T &items, const string &separator)
+    {
+        const size_t total = _ST_PRIVATE::join_size(items, separator.size());
+        if (total == 0)
+            return stream;
+        stream.expand_buffer(total);
+
+        char *output = stream.m_chars + stream.m_size;
+        bool first = true;
+        for (const auto &item : items) {
+            if (!first) {
+                std::char_traits<char>::copy(output, separator.c_str(), separator.size());
+                output += separator.size();
+            }
+            first = false;
+            std::char_traits<char>::copy(output, _ST_PRIVATE::join_data(item), item.size());
+            output += item.size();
+        }
+        stream.m_size += total;
+        return stream;
+    }
 }
 
 #endif // _ST_STRINGSTREAM_H
@@ -0,0 +1,238 @@
+/*  Copyright (c) 2026 Michael Hansen
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in
+    all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE. */
+
+#ifndef _ST_TRACE_H
+#define _ST_TRACE_H
+
+#include "st_config.h"
+
+#include <cstddef>
+
+#if defined(ST_ENABLE_TRACING)
+#   include <atomic>
+#   include <chrono>
+#   if defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+#       include <intrin.h>
+#       define _ST_TRACE_RDTSC
+#   elif (defined(__GNUC__) || defined(__clang__)) && (defined(__i386__) || defined(__x86_64__))
+#       include <x86intrin.h>
+#       define _ST_TRACE_RDTSC
+#   endif
+#   if defined(ST_HAVE_SYS_SDT_H)
+#       include <sys/sdt.h>
+#   endif
+#endif
+
+namespace ST
+{
+    enum class trace_event_t
+    {
+        trace_validate_utf8,    //! UTF-8 validation of incoming string data
+        trace_transcode,        //! Conversion between UTF-8/16/32 and Latin-1
+        trace_format,           //! Applying format arguments (bytes are not counted)
+        trace_replace,          //! ST::string::replace()
+    };
+    ST_ENUM_CONSTANT(trace_event_t, trace_validate_utf8);
+    ST_ENUM_CONSTANT(trace_event_t, trace_transcode);
+    ST_ENUM_CONSTANT(trace_event_t, trace_format);
+    ST_ENUM_CONSTANT(trace_event_t, trace_replace);
+
+    constexpr size_t trace_event_count = 4;
+
+    struct trace_counter
+    {
+        unsigned long long calls;
+        unsigned long long bytes;   // Input bytes processed
+        unsigned long long ticks;   // TSC cycles where available, else ns
+    };
+
+    // Per-thread call counts, byte counts and time spent in string_theory's
+    // hot paths.  The counters are only maintained when string_theory is
+    // configured with ST_ENABLE_TRACING; otherwise the trace points compile
+    // to nothing and snapshot() always returns zeros.  Nested trace points
+    // (e.g. validation inside a conversion) are counted in both events.
+    struct trace_stats
+    {
+        trace_counter events[trace_event_count];
+
+        static constexpr bool enabled() noexcept
+        {
+#if defined(ST_ENABLE_TRACING)
+            return true;
+#else
+            return false;
+#endif
+        }
+
+        // Counters for the calling thread since it started or since the
+        // last call to reset()
+        ST_NODISCARD
+        static trace_stats snapshot() noexcept;
+
+        static void reset() noexcept;
+
+        const trace_counter &operator[](trace_event_t event) const noexcept
+        {
+            return events[static_cast<size_t>(event)];
+        }
+
+        ST_NODISCARD
+        trace_stats operator-(const trace_stats &other) const noexcept
+        {
+            trace_stats result;
+            for (size_t i = 0; i < trace_event_count; ++i) {
+                result.events[i].calls = events[i].calls - other.events[i].calls;
+                result.events[i].bytes = events[i].bytes - other.events[i].bytes;
+                result.events[i].ticks = events[i].ticks - other.events[i].ticks;
+            }
+            return result;
+        }
+    };
+
+    // Called on the tracing thread at the end of every traced operation.
+    // Keep it cheap; it runs inside string_theory's hot paths.
+    typedef void (*trace_callback_t)(trace_event_t event, size_t bytes,
+                                     unsigned long long ticks);
+
+    // Install a callback for trace events, or nullptr to remove it.
+    // Returns the previously installed callback.
+    inline trace_callback_t set_trace_callback(trace_callback_t callback) noexcept;
+}
+
+namespace _ST_PRIVATE
+{
+#if defined(ST_ENABLE_TRACING)
+    inline ST::trace_stats &thread_trace_stats() noexcept
+    {
+        static thread_local ST::trace_stats stats = { };
+        return stats;
+    }
+
+    inline std::atomic<ST::trace_callback_t> &trace_callback() noexcept
+    {
+        static std::atomic<ST::trace_callback_t> callback(nullptr);
+        return callback;
+    }
+
+    inline unsigned long long trace_ticks() noexcept
+    {
+#if defined(_ST_TRACE_RDTSC)
+        return __rdtsc();
+#else
+        return static_cast<unsigned long long>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+    }
+
+    inline void trace_probe(ST::trace_event_t event, size_t bytes,
+                            unsigned long long ticks) noexcept
+    {
+#if defined(ST_HAVE_SYS_SDT_H)
+        // USDT probe names must be literal tokens
+        switch (event) {
+        case ST::trace_validate_utf8:
+            DTRACE_PROBE2(string_theory, validate_utf8, bytes, ticks);
+            break;
+        case ST::trace_transcode:
+            DTRACE_PROBE2(string_theory, transcode, bytes, ticks);
+            break;
+        case ST::trace_format:
+            DTRACE_PROBE2(string_theory, format, bytes, ticks);
+            break;
+        case ST::trace_replace:
+            DTRACE_PROBE2(string_theory, replace, bytes, ticks);
+            break;
+        }
+#else
+        (void)event;
+        (void)bytes;
+        (void)ticks;
+#endif
+    }
+
+    class trace_scope
+    {
+    public:
+        trace_scope(ST::trace_event_t event, size_t bytes) noexcept
+            : m_event(event), m_bytes(bytes), m_start(trace_ticks()) { }
+
+        trace_scope(const trace_scope &) = delete;
+        trace_scope &operator=(const trace_scope &) = delete;
+
+        ~trace_scope() noexcept
+        {
+            const unsigned long long ticks = trace_ticks() - m_start;
+            ST::trace_counter &counter = thread_trace_stats().events[static_cast<size_t>(m_event)];
+            counter.calls += 1;
+            counter.bytes += m_bytes;
+            counter.ticks += ticks;
+
+            trace_probe(m_event, m_bytes, ticks);
+            ST::trace_callback_t callback = trace_callback().load(std::memory_order_acquire);
+            if (callback)
+                callback(m_event, m_bytes, ticks);
+        }
+
+    private:
+        ST::trace_event_t m_event;
+        size_t m_bytes;
+        unsigned long long m_start;
+    };
+#endif
+}
+
+/* Trace the rest of the enclosing scope as the given ST::trace_event_t,
+ * processing bytes bytes of input.  When ST_ENABLE_TRACING is off, this
+ * expands to nothing and its arguments are not evaluated. */
+#if defined(ST_ENABLE_TRACING)
+#   define _ST_TRACE_SCOPE(event, bytes) \
+        _ST_PRIVATE::trace_scope _st_trace_scope(ST::event, (bytes))
+#else
+#   define _ST_TRACE_SCOPE(event, bytes) ((void)0)
+#endif
+
+inline ST::trace_stats ST::trace_stats::snapshot() noexcept
+{
+#if defined(ST_ENABLE_TRACING)
+    return _ST_PRIVATE::thread_trace_stats();
+#else
+    return trace_stats { };
+#endif
+}
+
+inline void ST::trace_stats::reset() noexcept
+{
+#if defined(ST_ENABLE_TRACING)
+    _ST_PRIVATE::thread_trace_stats() = trace_stats { };
+#endif
+}
+
+inline ST::trace_callback_t ST::set_trace_callback(trace_callback_t callback) noexcept
+{
+#if defined(ST_ENABLE_TRACING)
+    return _ST_PRIVATE::trace_callback().exchange(callback, std::memory_order_acq_rel);
+#else
+    (void)callback;
+    return nullptr;
+#endif
+}
+
+#endif // _ST_TRACE_H
@@ -22,6 +22,10 @@
 #define _ST_UTF_CONV_H
 
 #include "st_charbuffer.h"
+#include "st_trace.h"
+
+#include <cstring>      // For memcpy
+#include <iterator>     // For bidirectional_iterator_tag
 
 // This is 256MiB worth of UTF-8 string data
 #define ST_HUGE_BUFFER_SIZE 0x10000000
@@ -53,16 +57,22 @@ namespace ST
     inline char_buffer utf16_to_utf8(const char16_t *utf16, size_t size,
                                      utf_validation_t validation = ST_DEFAULT_VALIDATION)
     {
+        _ST_TRACE_SCOPE(trace_transcode, size * sizeof(char16_t));
         ST_ASSERT(size < ST_HUGE_BUFFER_SIZE, "String data buffer is too large");
 
+        const size_t ascii = _ST_PRIVATE::ascii_prefix(utf16, size);
+        if (ascii == size)
+            return _ST_PRIVATE::convert_ascii<char>(utf16, size);
+
         char_buffer result;
-        size_t u8size = _ST_PRIVATE::utf8_measure_from_utf16(utf16, size);
+        size_t u8size = ascii + _ST_PRIVATE::utf8_measure_from_utf16(utf16 + ascii, size - ascii);
         if (u8size == 0)
             return result;
 
         result.allocate(u8size);
-        auto error = _ST_PRIVATE::utf8_convert_from_utf16(result.data(), utf16,
-                                                          size, validation);
+        _ST_PRIVATE::copy_ascii(result.data(), utf16, ascii);
+        auto error = _ST_PRIVATE::utf8_convert_from_utf16(result.data() + ascii, utf16 + ascii,
+                                                          size - ascii, validation);
         _ST_PRIVATE::raise_conversion_error(error);
 
         return result;
@@ -79,16 +89,22 @@ namespace ST
     inline char_buffer utf32_to_utf8(const char32_t *utf32, size_t size,
                                      utf_validation_t validation = ST_DEFAULT_VALIDATION)
     {
+        _ST_TRACE_SCOPE(trace_transcode, size * sizeof(char32_t));
         ST_ASSERT(size < ST_HUGE_BUFFER_SIZE, "String data buffer is too large");
 
+        const size_t ascii = _ST_PRIVATE::ascii_prefix(utf32, size);
+        if (ascii == size)
+            return _ST_PRIVATE::convert_ascii<char>(utf32, size);
+
         char_buffer result;
-        size_t u8size = _ST_PRIVATE::utf8_measure_from_utf32(utf32, size);
+        size_t u8size = ascii + _ST_PRIVATE::utf8_measure_from_utf32(utf32 + ascii, size - ascii);
         if (u8size == 0)
             return result;
 
         result.allocate(u8size);
-        auto error = _ST_PRIVATE::utf8_convert_from_utf32(result.data(), utf32,
-                                                          size, validation);
+        _ST_PRIVATE::copy_ascii(result.data(), utf32, ascii);
+        auto error = _ST_PRIVATE::utf8_convert_from_utf32(result.data() + ascii, utf32 + ascii,
+                                                          size - ascii, validation);
         _ST_PRIVATE::raise_conversion_error(error);
 
         return result;
@@ -129,15 +145,21 @@ namespace ST
     ST_NODISCARD
     inline char_buffer latin_1_to_utf8(const char *astr, size_t size)
     {
+        _ST_TRACE_SCOPE(trace_transcode, size);
         ST_ASSERT(size < ST_HUGE_BUFFER_SIZE, "String data buffer is too large");
 
+        const size_t ascii = _ST_PRIVATE::ascii_prefix(astr, size);
+        if (ascii == size)
+            return char_buffer(astr, size);
+
         char_buffer result;
-        size_t u8size = _ST_PRIVATE::utf8_measure_from_latin_1(astr, size);
+        size_t u8size = ascii + _ST_PRIVATE::utf8_measure_from_latin_1(astr + ascii, size - ascii);
         if (u8size == 0)
             return result;
 
         result.allocate(u8size);
-        _ST_PRIVATE::utf8_convert_from_latin_1(result.data(), astr, size);
+        _ST_PRIVATE::copy_ascii(result.data(), astr, ascii);
+        _ST_PRIVATE::utf8_convert_from_latin_1(result.data() + ascii, astr + ascii, size - ascii);
 
         return result;
     }
@@ -152,16 +174,22 @@ namespace ST
     inline utf16_buffer utf8_to_utf16(const char *utf8, size_t size,
                                       utf_validation_t validation = ST_DEFAULT_VALIDATION)
     {
+        _ST_TRACE_SCOPE(trace_transcode, size);
         ST_ASSERT(size < ST_HUGE_BUFFER_SIZE, "String data buffer is too large");
 
-        size_t u16size = _ST_PRIVATE::utf16_measure_from_utf8(utf8, size);
+        const size_t ascii = _ST_PRIVATE::ascii_prefix(utf8, size);
+        if (ascii == size)
+            return _ST_PRIVATE::convert_ascii<char16_t>(utf8, size);
+
+        size_t u16size = ascii + _ST_PRIVATE::utf16_measure_from_utf8(utf8 + ascii, size - ascii);
         if (u16size == 0)
             return utf16_buffer();
 
         utf16_buffer result;
         result.allocate(u16size);
-        auto error = _ST_PRIVATE::utf16_convert_from_utf8(result.data(), utf8,
-                                                          size, validation);
+        _ST_PRIVATE::copy_ascii(result.data(), utf8, ascii);
+        auto error = _ST_PRIVATE::utf16_convert_from_utf8(result.data() + ascii, utf8 + ascii,
+                                                          size - ascii, validation);
         _ST_PRIVATE::raise_conversion_error(error);
 
         return result;
@@ -187,6 +215,7 @@ namespace ST
     inline utf16_buffer utf32_to_utf16(const char32_t *utf32, size_t size,
                                        utf_validation_t validation = ST_DEFAULT_VALIDATION)
     {
+        _ST_TRACE_SCOPE(trace_transcode, size * sizeof(char32_t));
         ST_ASSERT(size < ST_HUGE_BUFFER_SIZE, "String data buffer is too large");
 
         size_t u16size = _ST_PRIVATE::utf16_measure_from_utf32(utf32, size);
@@ -238,6 +267,7 @@ namespace ST
     ST_NODISCARD
     inline utf16_buffer latin_1_to_utf16(const char *astr, size_t size)
     {
+        _ST_TRACE_SCOPE(trace_transcode, size);
         ST_ASSERT(size < ST_HUGE_BUFFER_SIZE, "String data buffer is too large");
 
         utf16_buffer result;
@@ -260,16 +290,22 @@ namespace ST
     inline utf32_buffer utf8_to_utf32(const char *utf8, size_t size,
                                       utf_validation_t validation = ST_DEFAULT_VALIDATION)
     {
+        _ST_TRACE_SCOPE(trace_transcode, size);
         ST_ASSERT(size < ST_HUGE_BUFFER_SIZE, "String data buffer is too large");
 
-        size_t u32size = _ST_PRIVATE::utf32_measure_from_utf8(utf8, size);
+        const size_t ascii = _ST_PRIVATE::ascii_prefix(utf8, size);
+        if (ascii == size)
+            return _ST_PRIVATE::convert_ascii<char32_t>(utf8, size);
+
+        size_t u32size = ascii + _ST_PRIVATE::utf32_measure_from_utf8(utf8 + ascii, size - ascii);
         if (u32size == 0)
             return utf32_buffer();
 
         utf32_buffer result;
         result.allocate(u32size);
-        auto error = _ST_PRIVATE::utf32_convert_from_utf8(result.data(), utf8,
-                                                          size, validation);
+        _ST_PRIVATE::copy_ascii(result.data(), utf8, ascii);
+        auto error = _ST_PRIVATE::utf32_convert_from_utf8(result.data() + ascii, utf8 + ascii,
+                                                          size - ascii, validation);
         _ST_PRIVATE::raise_conversion_error(error);
 
         return result;
@@ -295,6 +331,7 @@ namespace ST
     inline utf32_buffer utf16_to_utf32(const char16_t *utf16, size_t size,
                                        utf_validation_t validation = ST_DEFAULT_VALIDATION)
     {
+        _ST_TRACE_SCOPE(trace_transcode, size * sizeof(char16_t));
         ST_ASSERT(size < ST_HUGE_BUFFER_SIZE, "String data buffer is too large");
 
         size_t u32size = _ST_PRIVATE::utf32_measure_from_utf16(utf16, size);
@@ -346,6 +383,7 @@ namespace ST
     ST_NODISCARD
     inline utf32_buffer latin_1_to_utf32(const char *astr, size_t size)
     {
+        _ST_TRACE_SCOPE(trace_transcode, size);
         ST_ASSERT(size < ST_HUGE_BUFFER_SIZE, "String data buffer is too large");
 
         utf32_buffer result;
@@ -372,14 +410,19 @@ namespace ST
     {
         ST_ASSERT(size < ST_HUGE_BUFFER_SIZE, "String data buffer is too large");
 
-        size_t u16size = _ST_PRIVATE::utf16_measure_from_utf8(utf8, size);
+        const size_t ascii = _ST_PRIVATE::ascii_prefix(utf8, size);
+        if (ascii == size)
+            return _ST_PRIVATE::convert_ascii<wchar_t>(utf8, size);
+
+        size_t u16size = ascii + _ST_PRIVATE::utf16_measure_from_utf8(utf8 + ascii, size - ascii);
         if (u16size == 0)
             return wchar_buffer();
 
         wchar_buffer result;
         result.allocate(u16size);
-        auto error = _ST_PRIVATE::utf16_convert_from_utf8(reinterpret_cast<char16_t *>(result.data()),
-                                                          utf8, size, validation);
+        _ST_PRIVATE::copy_ascii(result.data(), utf8, ascii);
+        auto error = _ST_PRIVATE::utf16_convert_from_utf8(reinterpret_cast<char16_t *>(result.data() + ascii),
+                                                          utf8 + ascii, size - ascii, validation);
         _ST_PRIVATE::raise_conversion_error(error);
 
         return result;
@@ -393,14 +436,19 @@ namespace ST
     {
         ST_ASSERT(size < ST_HUGE_BUFFER_SIZE, "String data buffer is too large");
 
-        size_t u32size = _ST_PRIVATE::utf32_measure_from_utf8(utf8, size);
+        const size_t ascii = _ST_PRIVATE::ascii_prefix(utf8, size);
+        if (ascii == size)
+            return _ST_PRIVATE::convert_ascii<wchar_t>(utf8, size);
+
+        size_t u32size = ascii + _ST_PRIVATE::utf32_measure_from_utf8(utf8 + ascii, size - ascii);
         if (u32size == 0)
             return wchar_buffer();
 
         wchar_buffer result;
         result.allocate(u32size);
-        auto error = _ST_PRIVATE::utf32_convert_from_utf8(reinterpret_cast<char32_t *>(result.data()),
-                                                          utf8, size, validation);
+        _ST_PRIVATE::copy_ascii(result.data(), utf8, ascii);
+        auto error = _ST_PRIVATE::utf32_convert_from_utf8(reinterpret_cast<char32_t *>(result.data() + ascii),
+                                                          utf8 + ascii, size - ascii, validation);
         _ST_PRIVATE::raise_conversion_error(error);
 
         return result;
@@ -545,16 +593,22 @@ namespace ST
                                        utf_validation_t validation = ST_DEFAULT_VALIDATION,
                                        bool substitute_out_of_range = true)
     {
+        _ST_TRACE_SCOPE(trace_transcode, size);
         ST_ASSERT(size < ST_HUGE_BUFFER_SIZE, "String data buffer is too large");
 
-        size_t asize = _ST_PRIVATE::latin_1_measure_from_utf8(utf8, size);
+        const size_t ascii = _ST_PRIVATE::ascii_prefix(utf8, size);
+        if (ascii == size)
+            return char_buffer(utf8, size);
+
+        size_t asize = ascii + _ST_PRIVATE::latin_1_measure_from_utf8(utf8 + ascii, size - ascii);
         if (asize == 0)
             return char_buffer();
 
         char_buffer result;
         result.allocate(asize);
-        auto error = _ST_PRIVATE::latin_1_convert_from_utf8(result.data(), utf8,
-                                                            size, validation,
+        _ST_PRIVATE::copy_ascii(result.data(), utf8, ascii);
+        auto error = _ST_PRIVATE::latin_1_convert_from_utf8(result.data() + ascii, utf8 + ascii,
+                                                            size - ascii, validation,
                                                             substitute_out_of_range);
         _ST_PRIVATE::raise_conversion_error(error);
 
@@ -586,6 +640,7 @@ namespace ST
                                         utf_validation_t validation = ST_DEFAULT_VALIDATION,
                                         bool substitute_out_of_range = true)
     {
+        _ST_TRACE_SCOPE(trace_transcode, size * sizeof(char16_t));
         ST_ASSERT(size < ST_HUGE_BUFFER_SIZE, "String data buffer is too large");
 
         size_t asize = _ST_PRIVATE::latin_1_measure_from_utf16(utf16, size);
@@ -616,6 +671,7 @@ namespace ST
                                         utf_validation_t validation = ST_DEFAULT_VALIDATION,
                                         bool substitute_out_of_range = true)
     {
+        _ST_TRACE_SCOPE(trace_transcode, size * sizeof(char32_t));
         ST_ASSERT(size < ST_HUGE_BUFFER_SIZE, "String data buffer is too large");
 
         char_buffer result;
@@ -667,6 +723,148 @@ namespace ST
         return wchar_to_latin_1(wstr.data(), wstr.size(), validation,
                                 substitute_out_of_range);
     }
+
+    // Decodes code points from UTF-8 data in place, without building a
+    // UTF-32 copy.  Invalid sequences are read as U+FFFD.
+    class code_point_iterator
+    {
+    public:
+        typedef std::bidirectional_iterator_tag iterator_category;
+        typedef char32_t value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef const char32_t *pointer;
+        typedef char32_t reference;
+
+        code_point_iterator() noexcept
+            : m_pos(), m_begin(), m_end() { }
+
+        code_point_iterator(const char *pos, const char *begin, const char *end) noexcept
+            : m_pos(pos), m_begin(begin), m_end(end) { }
+
+        ST_NODISCARD
+        char32_t operator*() const
+        {
+            const unsigned char *cp = _bytes(m_pos);
+            return _ST_PRIVATE::utf8_decode_next(cp, _bytes(m_end));
+        }
+
+        code_point_iterator &operator++()
+        {
+            const unsigned char *cp = _bytes(m_pos);
+            (void)_ST_PRIVATE::utf8_decode_next(cp, _bytes(m_end));
+            m_pos = reinterpret_cast<const char *>(cp);
+            return *this;
+        }
+
+        code_point_iterator operator++(int)
+        {
+            code_point_iterator prev = *this;
+            ++(*this);
+            return prev;
+        }
+
+        code_point_iterator &operator--()
+        {
+            m_pos = reinterpret_cast<const char *>(_ST_PRIVATE::utf8_previous(
+                        _bytes(m_begin), _bytes(m_pos)));
+            return *this;
+        }
+
+        code_point_iterator operator--(int)
+        {
+            code_point_iterator prev = *this;
+            --(*this);
+            return prev;
+        }
+
+        // Decodes up to count code points into out and advances past them.
+        // Returns the number of code points written, which is only less
+        // than count at the end of the data.
+        size_t decode_block(char32_t *out, size_t count)
+        {
+            const unsigned char *cp = _bytes(m_pos);
+            const unsigned char *ep = _bytes(m_end);
+            size_t decoded = 0;
+            while (decoded < count && cp < ep) {
+                if (*cp < 0x80) {
+                    // Widen a whole run of ASCII at once
+                    const size_t run = _ST_PRIVATE::ascii_prefix(reinterpret_cast<const char *>(cp),
+                            std::min(count - decoded, static_cast<size_t>(ep - cp)));
+                    for (size_t i = 0; i < run; ++i)
+                        out[decoded + i] = cp[i];
+                    decoded += run;
+                    cp += run;
+                } else {
+                    out[decoded++] = _ST_PRIVATE::utf8_decode_next(cp, ep);
+                }
+            }
+            m_pos = reinterpret_cast<const char *>(cp);
+            return decoded;
+        }
+
+        template <size_t count_N>
+        size_t decode_block(char32_t (&out)[count_N])
+        {
+            return decode_block(out, count_N);
+        }
+
+        // The UTF-8 data at the current position
+        ST_NODISCARD
+        const char *data() const noexcept { return m_pos; }
+
+        ST_NODISCARD
+        bool operator==(const code_point_iterator &other) const noexcept
+        {
+            return m_pos == other.m_pos;
+        }
+
+        ST_NODISCARD
+        bool operator!=(const code_point_iterator &other) const noexcept
+        {
+            return m_pos != other.m_pos;
+        }
+
+    private:
+        const char *m_pos;
+        const char *m_begin;
+        const char *m_end;
+
+        static const unsigned char *_bytes(const char *ptr) noexcept
+        {
+            return reinterpret_cast<const unsigned char *>(ptr);
+        }
+    };
+
+    class code_point_range
+    {
+    public:
+        typedef code_point_iterator iterator;
+        typedef code_point_iterator const_iterator;
+
+        code_point_range() noexcept : m_begin(), m_end() { }
+
+        code_point_range(const char *utf8, size_t size) noexcept
+            : m_begin(utf8), m_end(utf8 + size) { }
+
+        ST_NODISCARD
+        code_point_iterator begin() const noexcept
+        {
+            return code_point_iterator(m_begin, m_begin, m_end);
+        }
+
+        ST_NODISCARD
+        code_point_iterator end() const noexcept
+        {
+            return code_point_iterator(m_end, m_begin, m_end);
+        }
+
+        ST_NODISCARD
+        bool empty() const noexcept { return m_begin == m_end; }
+
+    private:
+        const char *m_begin;
+        const char *m_end;
+    };
 }
 
 #endif // _ST_UTF_CONV_H
@@ -21,6 +21,11 @@
 #ifndef _ST_UTF_CONV_PRIV_H
 #define _ST_UTF_CONV_PRIV_H
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#   include <emmintrin.h>
+#   define _ST_UTF_CONV_SSE2
+#endif
+
 namespace _ST_PRIVATE
 {
     constexpr unsigned int badchar_substitute = 0xFFFDu;
@@ -57,50 +62,248 @@ namespace _ST_PRIVATE
         }
     }
 
-#   define _ST_CHECK_NEXT_SEQ_BYTE() \
-    do { \
-        ++cp; \
-        if ((*cp & 0xC0) != 0x80) \
-            return conversion_error_t::invalid_utf8_seq; \
-    } while (false)
+    // Returns the number of leading ASCII characters in buffer
+    ST_NODISCARD
+    inline size_t ascii_prefix(const char *buffer, size_t size) noexcept
+    {
+        const unsigned char *const sp = reinterpret_cast<const unsigned char *>(buffer);
+        const unsigned char *cp = sp;
+        const unsigned char *ep = sp + size;
+
+        // Checked a word at a time until the first non-ASCII byte
+        while (ep - cp >= 8) {
+            unsigned long long word;
+            std::memcpy(&word, cp, sizeof(word));
+            if ((word & 0x8080808080808080ULL) != 0)
+                break;
+            cp += sizeof(word);
+        }
+        while (cp < ep && *cp < 0x80)
+            ++cp;
+        return static_cast<size_t>(cp - sp);
+    }
 
+    // The transcoders copy this many units directly and only convert the
+    // rest, so non-ASCII input isn't scanned twice
+    template <typename char_T>
     ST_NODISCARD
-    inline conversion_error_t validate_utf8(const char *buffer, size_t size)
+    size_t ascii_prefix(const char_T *buffer, size_t size) noexcept
+    {
+        size_t count = 0;
+        while (count < size
+                && static_cast<typename std::make_unsigned<char_T>::type>(buffer[count]) < 0x80)
+            ++count;
+        return count;
+    }
+
+    template <typename char_T>
+    ST_NODISCARD
+    bool is_ascii(const char_T *buffer, size_t size) noexcept
+    {
+        return ascii_prefix(buffer, size) == size;
+    }
+
+    // Number of UTF-8 continuation bytes (10xxxxxx) in a 64-bit word
+    inline size_t utf8_continuation_bytes(unsigned long long word) noexcept
+    {
+        // Bit 7 of each byte is kept only if bit 6 of the same byte is clear
+        const unsigned long long marks = word & ~(word << 1) & 0x8080808080808080ULL;
+        return static_cast<size_t>(((marks >> 7) * 0x0101010101010101ULL) >> 56);
+    }
+
+    // Counts the code points in a UTF-8 buffer, which for valid UTF-8 is
+    // every byte that is not a continuation byte
+    ST_NODISCARD
+    inline size_t utf8_count_code_points(const char *buffer, size_t size) noexcept
     {
         const unsigned char *cp = reinterpret_cast<const unsigned char *>(buffer);
         const unsigned char *ep = cp + size;
+        size_t continuations = 0;
+
+#if defined(_ST_UTF_CONV_SSE2)
+        // Continuation bytes are the only ones below 0xC0 when compared as
+        // signed.  The per-lane tallies are folded with psadbw before the
+        // 8-bit lanes can overflow.
+        const __m128i limit = _mm_set1_epi8(static_cast<char>(0xC0));
+        const __m128i zero = _mm_setzero_si128();
+        while (ep - cp >= 16) {
+            size_t blocks = std::min<size_t>(static_cast<size_t>(ep - cp) / 16, 255);
+            __m128i tally = zero;
+            for (; blocks; --blocks) {
+                const __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i *>(cp));
+                tally = _mm_sub_epi8(tally, _mm_cmpgt_epi8(limit, in));
+                cp += 16;
+            }
+            const __m128i sums = _mm_sad_epu8(tally, zero);
+            continuations += static_cast<size_t>(_mm_cvtsi128_si32(sums))
+                           + static_cast<size_t>(_mm_extract_epi16(sums, 4));
+        }
+#endif
+
+        while (ep - cp >= 8) {
+            unsigned long long word;
+            std::memcpy(&word, cp, sizeof(word));
+            continuations += utf8_continuation_bytes(word);
+            cp += sizeof(word);
+        }
         for (; cp < ep; ++cp) {
-            if (*cp < 0x80)
-                continue;
+            if ((*cp & 0xC0) == 0x80)
+                ++continuations;
+        }
+        return size - continuations;
+    }
 
-            if ((*cp & 0xE0) == 0xC0) {
-                // Two bytes
-                if (cp + 2 > ep)
-                    return conversion_error_t::incomplete_utf8_seq;
-                _ST_CHECK_NEXT_SEQ_BYTE();
-            } else if ((*cp & 0xF0) == 0xE0) {
-                // Three bytes
-                if (cp + 3 > ep)
-                    return conversion_error_t::incomplete_utf8_seq;
-                _ST_CHECK_NEXT_SEQ_BYTE();
-                _ST_CHECK_NEXT_SEQ_BYTE();
-            } else if ((*cp & 0xF8) == 0xF0) {
-                // Four bytes
-                if (cp + 4 > ep)
-                    return conversion_error_t::incomplete_utf8_seq;
-                _ST_CHECK_NEXT_SEQ_BYTE();
-                _ST_CHECK_NEXT_SEQ_BYTE();
-                _ST_CHECK_NEXT_SEQ_BYTE();
-            } else {
-                // Invalid sequence byte
-                return conversion_error_t::invalid_utf8_seq;
+    // Returns the byte offset of the code point count code points into a
+    // UTF-8 buffer, or size if the buffer is shorter than that
+    ST_NODISCARD
+    inline size_t utf8_skip_code_points(const char *buffer, size_t size,
+                                        size_t count) noexcept
+    {
+        const unsigned char *const sp = reinterpret_cast<const unsigned char *>(buffer);
+        const unsigned char *cp = sp;
+        const unsigned char *ep = sp + size;
+
+        // Whole words can be skipped while they don't contain the target
+        while (ep - cp >= 8) {
+            unsigned long long word;
+            std::memcpy(&word, cp, sizeof(word));
+            const size_t starts = sizeof(word) - utf8_continuation_bytes(word);
+            if (starts > count)
+                break;
+            count -= starts;
+            cp += sizeof(word);
+        }
+        for (; cp < ep; ++cp) {
+            if ((*cp & 0xC0) != 0x80) {
+                if (count == 0)
+                    break;
+                --count;
             }
         }
+        return static_cast<size_t>(cp - sp);
+    }
 
-        return conversion_error_t::success;
+    // Plain widening and narrowing copies, for data already known to be
+    // pure ASCII (which is identical in UTF-8, UTF-16, UTF-32 and Latin-1)
+    template <typename out_T, typename in_T>
+    void copy_ascii(out_T *out, const in_T *buffer, size_t size) noexcept
+    {
+        for (size_t i = 0; i < size; ++i)
+            out[i] = static_cast<out_T>(buffer[i]);
+    }
+
+    template <typename out_T, typename in_T>
+    ST_NODISCARD
+    ST::buffer<out_T> convert_ascii(const in_T *buffer, size_t size)
+    {
+        ST::buffer<out_T> result;
+        result.allocate(size);
+        copy_ascii(result.data(), buffer, size);
+        return result;
+    }
+
+    // Four-byte sequences starting above F4 8F encode code points past
+    // U+10FFFF, which UTF-16 can't represent
+    ST_NODISCARD
+    inline bool utf8_out_of_range(const unsigned char *seq) noexcept
+    {
+        return seq[0] > 0xF4 || (seq[0] == 0xF4 && seq[1] >= 0x90);
+    }
+
+    // Returns the number of bytes before the first invalid sequence in
+    // buffer, which is the whole buffer if error is set to success.  ascii
+    // is set if the valid part contains only ASCII characters.
+    ST_NODISCARD
+    inline size_t valid_utf8_prefix(const char *buffer, size_t size,
+                                    conversion_error_t &error, bool &ascii)
+    {
+        const unsigned char *const sp = reinterpret_cast<const unsigned char *>(buffer);
+        const unsigned char *cp = sp;
+        const unsigned char *ep = sp + size;
+        error = conversion_error_t::success;
+        ascii = true;
+        for ( ;; ) {
+            cp += ascii_prefix(reinterpret_cast<const char *>(cp), ep - cp);
+            if (cp == ep)
+                break;
+
+            ascii = false;
+
+            // Multi-byte sequences, until the next ASCII character
+            do {
+                size_t seq_size;
+                if ((*cp & 0xE0) == 0xC0) {
+                    seq_size = 2;
+                } else if ((*cp & 0xF0) == 0xE0) {
+                    seq_size = 3;
+                } else if ((*cp & 0xF8) == 0xF0) {
+                    seq_size = 4;
+                } else {
+                    // Invalid sequence byte
+                    error = conversion_error_t::invalid_utf8_seq;
+                    return static_cast<size_t>(cp - sp);
+                }
+
+                if (static_cast<size_t>(ep - cp) < seq_size) {
+                    error = conversion_error_t::incomplete_utf8_seq;
+                    return static_cast<size_t>(cp - sp);
+                }
+                if ((cp[1] & 0xC0) != 0x80
+                        || (seq_size > 2 && (cp[2] & 0xC0) != 0x80)
+                        || (seq_size > 3 && (cp[3] & 0xC0) != 0x80)
+                        || (seq_size > 3 && utf8_out_of_range(cp))) {
+                    error = conversion_error_t::invalid_utf8_seq;
+                    return static_cast<size_t>(cp - sp);
+                }
+
+                cp += seq_size;
+            } while (cp < ep && *cp >= 0x80);
+        }
+
+        return size;
+    }
+
+    ST_NODISCARD
+    inline conversion_error_t validate_utf8(const char *buffer, size_t size)
+    {
+        _ST_TRACE_SCOPE(trace_validate_utf8, size);
+        conversion_error_t error;
+        bool ascii;
+        (void)valid_utf8_prefix(buffer, size, error, ascii);
+        return error;
     }
 
-#undef _ST_CHECK_NEXT_SEQ_BYTE
+    // Validate UTF-8 data while copying it to output.  The data is handled
+    // in blocks small enough to stay in L1 cache between validating and
+    // copying them, so the input is only read from memory once.  Returns
+    // the number of bytes validated and copied before the first invalid
+    // sequence, and sets ascii if they were all ASCII characters.
+    ST_NODISCARD
+    inline size_t copy_valid_utf8(char *output, const char *buffer, size_t size,
+                                  conversion_error_t &error, bool &ascii)
+    {
+        constexpr size_t block_size = 4096;
+        size_t copied = 0;
+        ascii = true;
+        while (copied < size) {
+            const size_t block = std::min(block_size, size - copied);
+            bool block_ascii;
+            const size_t valid = valid_utf8_prefix(buffer + copied, block, error, block_ascii);
+            ascii = ascii && block_ascii;
+            std::char_traits<char>::copy(output + copied, buffer + copied, valid);
+            copied += valid;
+
+            // A sequence split by the end of the block is checked again at
+            // the start of the next one
+            const bool split = (error == conversion_error_t::incomplete_utf8_seq)
+                            && (copied - valid + block < size);
+            if (error != conversion_error_t::success && !split)
+                return copied;
+        }
+
+        error = conversion_error_t::success;
+        return copied;
+    }
 
     inline size_t append_chars(char *&output, const char *src, size_t count)
     {
@@ -146,7 +349,7 @@ namespace _ST_PRIVATE
             } else if ((*sp & 0xF8) == 0xF0) {
                 // Four bytes
                 if (sp + 4 > ep || (sp[1] & 0xC0) != 0x80 || (sp[2] & 0xC0) != 0x80
-                                || (sp[3] & 0xC0) != 0x80) {
+                                || (sp[3] & 0xC0) != 0x80 || utf8_out_of_range(sp)) {
                     output_size += append_chars(output, badchar_substitute_utf8,
                                                 badchar_substitute_utf8_len);
                     sp += 1;
@@ -165,14 +368,59 @@ namespace _ST_PRIVATE
         return output_size;
     }
 
+    // Repair the invalid sequences in buffer in a single pass, given that
+    // the first valid_size bytes are already known to be valid.
     ST_NODISCARD
-    inline ST::char_buffer cleanup_utf8_buffer(const ST::char_buffer &buffer)
+    inline ST::char_buffer repair_utf8_buffer(const char *buffer, size_t size,
+                                              size_t valid_size)
+    {
+        // Worst case: every remaining byte is replaced by a substitute
+        const size_t max_size = valid_size
+                + (size - valid_size) * badchar_substitute_utf8_len;
+        char stack_buffer[256];
+        char *repaired = (max_size < sizeof(stack_buffer))
+                       ? stack_buffer : alloc_chars<char>(max_size + 1);
+        std::char_traits<char>::copy(repaired, buffer, valid_size);
+        const size_t repaired_size = valid_size
+                + cleanup_utf8(repaired + valid_size, buffer + valid_size,
+                               size - valid_size);
+        repaired[repaired_size] = 0;
+        if (repaired == stack_buffer)
+            return ST::char_buffer(stack_buffer, repaired_size);
+
+        // Don't hold on to the worst-case block if most of it went unused
+        if (repaired_size < max_size / 2) {
+            ST::char_buffer result(repaired, repaired_size);
+            free_chars(repaired);
+            return result;
+        }
+
+        ST::char_buffer result;
+        result.adopt(repaired, repaired_size);
+        return result;
+    }
+
+    // Copy UTF-8 data into a new buffer, validating it on the way.  Invalid
+    // sequences are replaced if substitute is true, and otherwise throw an
+    // ST::unicode_error.  ascii is set if the result is pure ASCII.
+    ST_NODISCARD
+    inline ST::char_buffer copy_utf8_buffer(const char *buffer, size_t size,
+                                            bool substitute, bool &ascii)
     {
-        size_t clean_size = cleanup_utf8(nullptr, buffer.data(), buffer.size());
-        ST::char_buffer cb_clean;
-        cb_clean.allocate(clean_size);
-        cleanup_utf8(cb_clean.data(), buffer.data(), buffer.size());
-        return cb_clean;
+        _ST_TRACE_SCOPE(trace_validate_utf8, size);
+
+        ST::char_buffer result;
+        result.allocate(size);
+        conversion_error_t error;
+        const size_t valid_size = copy_valid_utf8(result.data(), buffer, size, error, ascii);
+        if (error == conversion_error_t::success)
+            return result;
+
+        ascii = false;
+
+        if (!substitute)
+            raise_conversion_error(error);
+        return repair_utf8_buffer(buffer, size, valid_size);
     }
 
     ST_NODISCARD
@@ -218,6 +466,10 @@ namespace _ST_PRIVATE
                 utf8 += 1;
                 return error_char(conversion_error_t::incomplete_utf8_seq);
             }
+            if (utf8_out_of_range(utf8)) {
+                utf8 += 1;
+                return error_char(conversion_error_t::invalid_utf8_seq);
+            }
             bigch  = (*utf8++ & 0x07) << 18;
             bigch |= (*utf8++ & 0x3F) << 12;
             bigch |= (*utf8++ & 0x3F) << 6;
@@ -246,6 +498,41 @@ namespace _ST_PRIVATE
         }
     }
 
+    // Decodes one code point and advances utf8 past it, substituting U+FFFD
+    // for an invalid sequence
+    ST_NODISCARD
+    inline char32_t utf8_decode_next(const unsigned char *&utf8, const unsigned char *end)
+    {
+        if (*utf8 < 0x80)
+            return *utf8++;
+        const char32_t ch = extract_utf8(utf8, end);
+        return (char_error(ch) == conversion_error_t::success) ? ch : badchar_substitute;
+    }
+
+    // Returns the start of the code point ending at pos.  This matches the
+    // forward decoding of extract_utf8, which consumes a single byte of any
+    // invalid sequence.
+    ST_NODISCARD
+    inline const unsigned char *utf8_previous(const unsigned char *begin,
+                                              const unsigned char *pos)
+    {
+        const unsigned char *lead = pos - 1;
+        while (lead > begin && pos - lead < 4 && (*lead & 0xC0) == 0x80)
+            --lead;
+
+        const unsigned char *cp = lead;
+        (void)extract_utf8(cp, pos);
+        return (cp == pos) ? lead : pos - 1;
+    }
+
+    // Decodes the code point starting at byte offset in buffer
+    ST_NODISCARD
+    inline char32_t utf8_decode_at(const char *buffer, size_t size, size_t offset)
+    {
+        const unsigned char *cp = reinterpret_cast<const unsigned char *>(buffer) + offset;
+        return utf8_decode_next(cp, reinterpret_cast<const unsigned char *>(buffer) + size);
+    }
+
     ST_NODISCARD
     inline conversion_error_t write_utf8(char *&dest, char32_t ch)
     {
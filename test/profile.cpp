@@ -26,17 +26,26 @@
 #define _SILENCE_CXX17_CODECVT_HEADER_DEPRECATION_WARNING
 #define _CRT_SECURE_NO_WARNINGS
 
-#include <chrono>
 #include <functional>
 #include <locale>
 #include <codecvt>
 #include <sstream>
 #include <fstream>
 #include <cmath>
+#include <vector>
+#include <unordered_map>
 
 #include "st_format.h"
 #include "st_stdio.h"
 #include "st_iostream.h"
+#include "st_linereader.h"
+#include "st_codecs.h"
+#include "st_codepoints.h"
+#include "st_hashed_string.h"
+#include "st_keyword_map.h"
+
+#include "profile_harness.h"
+#include "profile_corpus.h"
 
 #ifdef ST_PROFILE_HAVE_BOOST
 #   include <boost/format.hpp>
@@ -85,20 +94,25 @@ volatile int I;
 volatile long L;
 #define NO_OPTIMIZE_L(x) L = x;
 
+static bench::harness _bench;
+
 template <typename Code>
 void _measure(const char *title, const Code &fun)
 {
-    auto clk = std::chrono::high_resolution_clock::now();
-    for (size_t i = 0; i < 100000; ++i)
-        fun();
+    _bench.run(title, 0, fun);
+}
 
-    auto dur = std::chrono::high_resolution_clock::now() - clk;
-    ST::printf("{36}: {6.2f} ms\n", title,
-         std::chrono::duration<double, std::milli>(dur).count());
+template <typename Code>
+void _measure_bytes(const ST::string &title, size_t bytes, const Code &fun)
+{
+    _bench.run(title, bytes, fun);
 }
 
-int main(int, char **)
+int main(int argc, char *argv[])
 {
+    if (!_bench.parse_args(argc, argv))
+        return 1;
+
     _measure("Nothing", []() { });
 
     _measure("Empty std::string", []() {
@@ -125,7 +139,7 @@ int main(int, char **)
     });
 #endif
 
-    ST::printf("\n");
+    _bench.separator();
 
     _measure("Short std::string", []() {
         std::string short_str("Short");
@@ -166,7 +180,7 @@ int main(int, char **)
     });
 #endif
 
-    ST::printf("\n");
+    _bench.separator();
 
     _measure("Long std::string", []() {
         std::string long_str("This is a long string.  Testing the excessively long long string.");
@@ -208,7 +222,7 @@ int main(int, char **)
     });
 #endif
 
-    ST::printf("\n");
+    _bench.separator();
 
     std::string _ss1("Short");
     _measure("Copy short std::string", [&_ss1]() {
@@ -238,7 +252,7 @@ int main(int, char **)
     });
 #endif
 
-    ST::printf("\n");
+    _bench.separator();
 
     std::string _ss2("This is a long string.  Testing the excessively long long string.");
     _measure("Copy long std::string", [&_ss2]() {
@@ -268,7 +282,7 @@ int main(int, char **)
     });
 #endif
 
-    ST::printf("\n");
+    _bench.separator();
 
     std::string _ss3[] = {"Piece 1", "Piece 2", "Piece 3"};
     _measure("std::string (+)", [&_ss3]() {
@@ -298,7 +312,52 @@ int main(int, char **)
     });
 #endif
 
-    ST::printf("\n");
+    const std::string _ss_prefix = "settings.display.", _ss_key = "resolution_preset",
+                      _ss_value = "1920x1080 (widescreen, native)";
+    _measure("std::string (+ key=value)", [&]() {
+        std::string result = _ss_prefix + _ss_key + "=" + _ss_value + "\n";
+        NO_OPTIMIZE(result.c_str());
+    });
+
+    const ST::string _st_prefix = "settings.display.", _st_key = "resolution_preset",
+                     _st_value = "1920x1080 (widescreen, native)";
+    _measure("ST::string (+ key=value)", [&]() {
+        ST::string result = _st_prefix + _st_key + "=" + _st_value + "\n";
+        NO_OPTIMIZE(result.c_str());
+    });
+
+    _measure("ST::concat (key=value)", [&]() {
+        ST::string result = ST::concat(_st_prefix, _st_key, '=', _st_value, '\n');
+        NO_OPTIMIZE(result.c_str());
+    });
+
+    std::vector<ST::string> _st_words;
+    for (int i = 0; i < 1000; ++i)
+        _st_words.push_back(ST::format("word{}", i));
+    _measure("ST::string_stream (join 1000)", [&_st_words]() {
+        ST::string_stream ss;
+        bool first = true;
+        for (const ST::string &word : _st_words) {
+            if (!first)
+                ss << ", ";
+            first = false;
+            ss << word;
+        }
+        NO_OPTIMIZE(ss.to_string().c_str());
+    });
+
+    _measure("ST::join_to (1000)", [&_st_words]() {
+        ST::string_stream ss;
+        ST::join_to(ss, _st_words, ST_LITERAL(", "));
+        NO_OPTIMIZE(ss.to_string().c_str());
+    });
+
+    _measure("ST::join (1000)", [&_st_words]() {
+        ST::string result = ST::join(_st_words, ST_LITERAL(", "));
+        NO_OPTIMIZE(result.c_str());
+    });
+
+    _bench.separator();
 
     const char _cs2[] = "This is a long string.  Testing the excessively long long string.";
     _measure("strcmp", [&_cs2]() {
@@ -342,7 +401,62 @@ int main(int, char **)
     });
 #endif
 
-    ST::printf("\n");
+    _bench.separator();
+
+    std::unordered_map<ST::string, int, ST::hash, ST::equal> _st_map;
+    for (int i = 0; i < 100; ++i)
+        _st_map[ST::format("settings.display.option_{}", i)] = i;
+    const char *_map_key = "settings.display.option_42";
+    _measure("unordered_map find (ST::string key)", [&_st_map, _map_key]() {
+        auto iter = _st_map.find(ST::string(_map_key));
+        NO_OPTIMIZE_I(iter->second);
+    });
+
+    _measure("unordered_map find (const char *)", [&_st_map, _map_key]() {
+        auto iter = _st_map.find(_map_key);
+        NO_OPTIMIZE_I(iter->second);
+    });
+
+    const auto _st_map2 = _st_map, _st_map3 = _st_map;
+    const ST::string _map_st_key = _map_key;
+    _measure("map find x3 (ST::string)", [&]() {
+        int total = _st_map.find(_map_st_key)->second + _st_map2.find(_map_st_key)->second
+                  + _st_map3.find(_map_st_key)->second;
+        NO_OPTIMIZE_I(total);
+    });
+
+    const ST::hashed_string _map_hashed_key(_map_st_key);
+    _measure("map find x3 (hashed_string)", [&]() {
+        int total = _st_map.find(_map_hashed_key)->second + _st_map2.find(_map_hashed_key)->second
+                  + _st_map3.find(_map_hashed_key)->second;
+        NO_OPTIMIZE_I(total);
+    });
+
+    static const char *const _http_headers[] = {
+        "Accept", "Accept-Charset", "Accept-Encoding", "Accept-Language",
+        "Authorization", "Cache-Control", "Connection", "Content-Encoding",
+        "Content-Length", "Content-Type", "Cookie", "Date", "ETag", "Expect",
+        "Host", "If-Match", "If-Modified-Since", "If-None-Match", "Origin",
+        "Range", "Referer", "Transfer-Encoding", "Upgrade", "User-Agent",
+    };
+    const ST::string _header_name = ST_LITERAL("Transfer-Encoding");
+    _measure("keyword dispatch (if chain)", [&_header_name]() {
+        ST_ssize_t index = -1;
+        for (size_t i = 0; i < sizeof(_http_headers) / sizeof(_http_headers[0]); ++i) {
+            if (_header_name == _http_headers[i]) {
+                index = static_cast<ST_ssize_t>(i);
+                break;
+            }
+        }
+        NO_OPTIMIZE_L(static_cast<long>(index));
+    });
+
+    static const ST::keyword_map<24> _header_map(_http_headers);
+    _measure("keyword dispatch (keyword_map)", [&_header_name]() {
+        NO_OPTIMIZE_L(static_cast<long>(_header_map.find(_header_name)));
+    });
+
+    _bench.separator();
 
     const char *_is1 = "5143200";
     _measure("strtol", [&_is1]() {
@@ -364,7 +478,7 @@ int main(int, char **)
     });
 #endif
 
-    ST::printf("\n");
+    _bench.separator();
 
     int _ival = 5143200;
     _measure("sprintf number", [_ival]() {
@@ -397,7 +511,7 @@ int main(int, char **)
     });
 #endif
 
-    ST::printf("\n");
+    _bench.separator();
 
     std::string _ss4 = "One|Two|Part Three is much longer than the others|Part Four";
     _measure("std::getline", [&_ss4]() {
@@ -443,7 +557,7 @@ int main(int, char **)
     });
 #endif
 
-    ST::printf("\n");
+    _bench.separator();
 
     _measure("std::string::substr", [&_ss4]() {
         std::string sub = _ss4.substr(8, 41);
@@ -470,7 +584,7 @@ int main(int, char **)
     });
 #endif
 
-    ST::printf("\n");
+    _bench.separator();
 
     std::string _ssu8("Some UTF-8 text: \xc2\xab\xf0\x9f\x8d\x8c\xc2\xbb");
     std::wstring_convert<std::codecvt_utf8_utf16<codecvt_char16_t>, codecvt_char16_t> _wsc_u8_u16;
@@ -654,7 +768,7 @@ int main(int, char **)
     });
 #endif
 
-    ST::printf("\n");
+    _bench.separator();
 
     _measure("static snprintf", []() {
         char buffer[256];
@@ -711,7 +825,7 @@ int main(int, char **)
     });
 #endif
 
-    ST::printf("\n");
+    _bench.separator();
 
 #ifdef _WIN32
 #   define DEVNULL "nul"
@@ -729,6 +843,14 @@ int main(int, char **)
             ST::printf(devnull, "This {} is {6.2f} a {} test {}.", 42, M_PI,
                                 "<Singin' in the rain>", '?');
         });
+
+        _measure("printf (padded)", [devnull]() {
+            fprintf(devnull, "[%40s] [%-40d]", "<Singin' in the rain>", 42);
+        });
+
+        _measure("ST::printf (padded)", [devnull]() {
+            ST::printf(devnull, "[{>40}] [{<40}]", "<Singin' in the rain>", 42);
+        });
     } else {
         ST::printf("{32}: Couldn't open file " DEVNULL "\n", "printf");
         ST::printf("{32}: Couldn't open file " DEVNULL "\n", "ST::printf");
@@ -741,10 +863,95 @@ int main(int, char **)
             ST::writef(devnull_ofs, "This {} is {6.2f} a {} test {}.", 42, M_PI,
                                     "<Singin' in the rain>", '?');
         });
+
+        _measure("ST::writef (padded)", [&devnull_ofs]() {
+            ST::writef(devnull_ofs, "[{>40}] [{<40}]", "<Singin' in the rain>", 42);
+        });
+
+        ST::string _st4 = ST::string::fill(1000, 'x');
+        _measure("ostream << ST::string", [&devnull_ofs, &_st4]() {
+            devnull_ofs << _st4;
+        });
     } else {
         ST::printf("{32}: Couldn't open file " DEVNULL "\n", "ST::writef");
     }
 
+    std::string _ss_tokens;
+    for (int i = 0; i < 10; ++i)
+        _ss_tokens += "token" + std::to_string(i) + " " + std::string(100, 'x') + "\n";
+    std::istringstream _iss;
+    _measure("istream >> ST::string", [&_ss_tokens, &_iss]() {
+        _iss.clear();
+        _iss.str(_ss_tokens);
+        ST::string token;
+        while (_iss >> token)
+            NO_OPTIMIZE(token.c_str());
+    });
+
+    _measure("ST::getline", [&_ss_tokens, &_iss]() {
+        _iss.clear();
+        _iss.str(_ss_tokens);
+        ST::string token;
+        while (ST::getline(_iss, token))
+            NO_OPTIMIZE(token.c_str());
+    });
+
+    {
+        // Line-by-line ingestion of a large newline-delimited file
+        const char *lines_path = "st_profile_lines.txt";
+        FILE *lines_f = fopen(lines_path, "wb");
+        if (lines_f) {
+            for (int i = 0; i < 100000; ++i)
+                fprintf(lines_f, "%d: log line with some representative text in it\n", i);
+            const size_t lines_size = static_cast<size_t>(ftell(lines_f));
+            fclose(lines_f);
+
+            _measure_bytes("100K lines std::getline + set", lines_size, [lines_path]() {
+                std::ifstream lines_ifs(lines_path, std::ios::binary);
+                std::string line;
+                ST::string st_line;
+                size_t total = 0;
+                while (std::getline(lines_ifs, line)) {
+                    st_line.set(line.c_str(), line.size());
+                    total += st_line.size();
+                }
+                NO_OPTIMIZE_L(static_cast<long>(total));
+            });
+
+            _measure_bytes("100K lines ST::line_reader", lines_size, [lines_path]() {
+                FILE *lines_f = fopen(lines_path, "rb");
+                ST::line_reader reader(lines_f);
+                ST::string st_line;
+                size_t total = 0;
+                while (reader.next(st_line))
+                    total += st_line.size();
+                fclose(lines_f);
+                NO_OPTIMIZE_L(static_cast<long>(total));
+            });
+
+            _measure_bytes("100K lines ST::line_reader (views)", lines_size, [lines_path]() {
+                FILE *lines_f = fopen(lines_path, "rb");
+                ST::line_reader view_reader(lines_f);
+                size_t total = 0;
+                while (view_reader.next())
+                    total += view_reader.size();
+                fclose(lines_f);
+                NO_OPTIMIZE_L(static_cast<long>(total));
+            });
+
+            remove(lines_path);
+        }
+    }
+
+    std::wofstream devnull_wofs;
+    devnull_wofs.open(DEVNULL);
+    if (devnull_wofs.is_open()) {
+        ST::string _st5 = ST::string::fill(1000, 'x');
+        _measure("wostream << ST::string", [&devnull_wofs, &_st5]() {
+            devnull_wofs << _st5;
+        });
+    }
+
 #ifdef ST_PROFILE_HAVE_FMT
     if (devnull) {
         _measure("fmt::print (FILE*)", [devnull]() {
@@ -784,5 +991,226 @@ int main(int, char **)
         NO_OPTIMIZE(ss.to_string().c_str());
     });
 
-    return 0;
+    _bench.separator();
+
+    // Throughput over a range of input sizes
+    for (size_t size : bench::sweep_sizes) {
+        if (!_bench.size_enabled(size))
+            continue;
+
+        std::string text;
+        text.reserve(size);
+        while (text.size() < size)
+            text += "The quick brown fox jumps over the lazy dog.  ";
+        text.resize(size);
+
+        _measure_bytes(ST::format("ST::string::from_utf8 ({})", bench::size_label(size)),
+                       size, [&text]() {
+            ST::string str = ST::string::from_utf8(text.c_str(), text.size());
+            NO_OPTIMIZE(str.c_str());
+        });
+
+        _measure_bytes(ST::format("ST::string (assume_valid) ({})", bench::size_label(size)),
+                       size, [&text]() {
+            ST::string str = ST::string::from_utf8(text.c_str(), text.size(),
+                                                   ST::assume_valid);
+            NO_OPTIMIZE(str.c_str());
+        });
+    }
+
+    for (size_t size : bench::sweep_sizes) {
+        if (!_bench.size_enabled(size))
+            continue;
+
+        std::vector<unsigned char> data(size);
+        for (size_t i = 0; i < data.size(); ++i)
+            data[i] = static_cast<unsigned char>((i * 7919) >> 3);
+
+        _measure_bytes(ST::format("ST::base64_encode ({})", bench::size_label(size)),
+                       size, [&data]() {
+            ST::string encoded = ST::base64_encode(data.data(), data.size());
+            NO_OPTIMIZE(encoded.c_str());
+        });
+
+        const ST::string b64_encoded = ST::base64_encode(data.data(), data.size());
+        _measure_bytes(ST::format("ST::base64_decode ({})", bench::size_label(size)),
+                       size, [&b64_encoded]() {
+            ST::char_buffer decoded = ST::base64_decode(b64_encoded);
+            NO_OPTIMIZE(decoded.data());
+        });
+
+        _measure_bytes(ST::format("ST::hex_encode ({})", bench::size_label(size)),
+                       size, [&data]() {
+            ST::string encoded = ST::hex_encode(data.data(), data.size());
+            NO_OPTIMIZE(encoded.c_str());
+        });
+
+        const ST::string hex_encoded = ST::hex_encode(data.data(), data.size());
+        std::vector<unsigned char> hex_out(size);
+        _measure_bytes(ST::format("ST::hex_decode ({})", bench::size_label(size)),
+                       size, [&hex_encoded, &hex_out]() {
+            NO_OPTIMIZE_L(static_cast<long>(ST::hex_decode(hex_encoded, hex_out.data(),
+                                                           hex_out.size())));
+        });
+    }
+
+    _bench.separator();
+
+    // Conversion, search and case mapping over generated text with
+    // different character mixes
+    for (bench::corpus_kind kind : bench::corpus_kinds) {
+        for (size_t size : bench::corpus_sizes) {
+            if (!_bench.size_enabled(size))
+                continue;
+
+            bench::corpus input(kind, size);
+            const ST::string suffix = ST::format(" [{}, {}]", bench::corpus_name(kind),
+                                                 bench::size_label(size));
+            const ST::utf_validation_t validation = (kind == bench::corpus_kind::invalid)
+                                                  ? ST::substitute_invalid
+                                                  : ST::check_validity;
+
+            _measure_bytes("from_utf8" + suffix, size, [&input, validation]() {
+                const std::string &bytes = input.bytes();
+                ST::string str = ST::string::from_utf8(bytes.c_str(), bytes.size(),
+                                                       validation);
+                NO_OPTIMIZE(str.c_str());
+            });
+            _measure_bytes("to_utf16" + suffix, size, [&input]() {
+                NO_OPTIMIZE(input.text().to_utf16().data());
+            });
+            _measure_bytes("to_utf32" + suffix, size, [&input]() {
+                NO_OPTIMIZE(input.text().to_utf32().data());
+            });
+            _measure_bytes("to_latin_1" + suffix, size, [&input]() {
+                NO_OPTIMIZE(input.text().to_latin_1().data());
+            });
+            _measure_bytes("from_utf16" + suffix, size, [&input, validation]() {
+                NO_OPTIMIZE(ST::string::from_utf16(input.utf16(), validation).c_str());
+            });
+            _measure_bytes("from_utf32" + suffix, size, [&input, validation]() {
+                NO_OPTIMIZE(ST::string::from_utf32(input.utf32(), validation).c_str());
+            });
+            _measure_bytes("find (char)" + suffix, size, [&input]() {
+                NO_OPTIMIZE_L(static_cast<long>(input.text().find('\t')));
+            });
+            _measure_bytes("find (string)" + suffix, size, [&input]() {
+                NO_OPTIMIZE_L(static_cast<long>(input.text().find("needle")));
+            });
+            _measure_bytes("find (string, CI)" + suffix, size, [&input]() {
+                NO_OPTIMIZE_L(static_cast<long>(input.text().find("NEEDLE",
+                                                ST::case_insensitive)));
+            });
+            _measure_bytes("to_lower" + suffix, size, [&input]() {
+                NO_OPTIMIZE(input.text().to_lower().c_str());
+            });
+            _measure_bytes("to_upper" + suffix, size, [&input]() {
+                NO_OPTIMIZE(input.text().to_upper().c_str());
+            });
+            _measure_bytes("split" + suffix, size, [&input]() {
+                NO_OPTIMIZE_L(static_cast<long>(input.text().split(' ').size()));
+            });
+            _measure_bytes("tokenize" + suffix, size, [&input]() {
+                NO_OPTIMIZE_L(static_cast<long>(input.text().tokenize().size()));
+            });
+            _measure_bytes("tokenize (char_set)" + suffix, size, [&input]() {
+                static const ST::char_set delims(ST_WHITESPACE);
+                NO_OPTIMIZE_L(static_cast<long>(input.text().tokenize(delims).size()));
+            });
+            _measure_bytes("code_points" + suffix, size, [&input]() {
+                char32_t sum = 0;
+                for (char32_t ch : input.text().code_points())
+                    sum += ch;
+                NO_OPTIMIZE_L(static_cast<long>(sum));
+            });
+            _measure_bytes("code_points (decode_block)" + suffix, size, [&input]() {
+                const ST::code_point_range range = input.text().code_points();
+                char32_t block[64];
+                char32_t sum = 0;
+                for (auto it = range.begin(); it != range.end(); ) {
+                    const size_t count = it.decode_block(block);
+                    for (size_t i = 0; i < count; ++i)
+                        sum += block[i];
+                }
+                NO_OPTIMIZE_L(static_cast<long>(sum));
+            });
+            _measure_bytes("code_point_count" + suffix, size, [&input]() {
+                NO_OPTIMIZE_L(static_cast<long>(input.text().code_point_count()));
+            });
+
+            // Indexed access is measured per lookup, once the index is built
+            const ST::code_point_index index(input.text());
+            const size_t middle = index.size() / 2;
+            _bench.run("code_point_at (indexed)" + suffix, 0, [&index, middle]() {
+                NO_OPTIMIZE_L(static_cast<long>(index.code_point_at(middle)));
+            });
+        }
+    }
+
+    _bench.separator();
+
+    {
+        // Bulk storage of many short strings is dominated by sizeof(ST::string)
+        ST::printf("{36}: {} bytes\n", "sizeof(ST::string)", sizeof(ST::string));
+        _measure("1M short ST::strings (vector)", []() {
+            constexpr size_t bulk_count = 1000000;
+            std::vector<ST::string> bulk;
+            bulk.reserve(bulk_count);
+            for (size_t i = 0; i < bulk_count; ++i)
+                bulk.emplace_back(ST::string::from_uint(i));
+            size_t total = 0;
+            for (const auto &str : bulk)
+                total += str.size();
+            NO_OPTIMIZE_L(static_cast<long>(total));
+        });
+    }
+
+    if (ST::alloc_stats::enabled()) {
+        // Allocation budgets for common operations.  A regression here
+        // (e.g. an extra copy of an argument) fails the profile run.
+        _bench.separator();
+
+        static const char long_text[] =
+            "This string is long enough that it never fits in any inline storage, "
+            "regardless of how ST::buffer is configured.";
+        const ST::string text = ST::string::from_utf8(long_text);
+
+        _bench.check_allocs("ST::format (short)", 0, []() {
+            NO_OPTIMIZE(ST::format("{} + {} = {}", 40, 2, 42).c_str());
+        });
+        _bench.check_allocs("ST::format (long)", 1, [&text]() {
+            NO_OPTIMIZE(ST::format("<{}>", text).c_str());
+        });
+        _bench.check_allocs("ST::concat (6 operands)", 1, [&text]() {
+            ST::string result = ST::concat(text, ST_LITERAL(": "), text, '=', text, "\n");
+            NO_OPTIMIZE(result.c_str());
+        });
+        _bench.check_allocs("ST::string::split (short)", 0, []() {
+            NO_OPTIMIZE_L(static_cast<long>(ST_LITERAL("a,bb,ccc,dddd").split(',').size()));
+        });
+        _bench.check_allocs("ST::string::replace (long)", 1, [&text]() {
+            NO_OPTIMIZE(text.replace("string", "text").c_str());
+        });
+        _bench.check_allocs("ST::string_stream (10x long)", 3, [&text]() {
+            ST::string_stream ss;
+            for (int i = 0; i < 10; ++i)
+                ss << text;
+            NO_OPTIMIZE(ss.take_string().c_str());
+        });
+        const ST::string join_items[] = { text, text, text };
+        _bench.check_allocs("ST::join (3x long)", 1, [&join_items]() {
+            NO_OPTIMIZE(ST::join(join_items, ST_LITERAL(", ")).c_str());
+        });
+        _bench.check_allocs("unordered_map find (const char *)", 0, [&_st_map, _map_key]() {
+            NO_OPTIMIZE_I(_st_map.find(_map_key)->second);
+        });
+        _bench.check_allocs("ST::string::code_points (long)", 0, [&text]() {
+            char32_t sum = 0;
+            for (char32_t ch : text.code_points())
+                sum += ch;
+            NO_OPTIMIZE_L(static_cast<long>(sum));
+        });
+    }
+
+    return (_bench.write_reports() && _bench.budgets_met()) ? 0 : 1;
 }
@@ -0,0 +1,258 @@
+/*  Copyright (c) 2026 Michael Hansen
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in
+    all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE. */
+
+// Deterministic text corpora for string_profile, so conversion, search
+// and case mapping can be measured on realistic character mixes rather
+// than one short ASCII sentence.
+
+#ifndef _ST_PROFILE_CORPUS_H
+#define _ST_PROFILE_CORPUS_H
+
+#include <cstdint>
+#include <string>
+
+#include "st_string.h"
+
+namespace bench
+{
+    enum class corpus_kind
+    {
+        ascii,          // English-like words and punctuation
+        latin_1,        // Western European text, ~30% 2-byte sequences
+        cjk,            // Mostly 3-byte BMP ideographs and kana
+        emoji,          // Chat text with frequent 4-byte astral characters
+        invalid         // UTF-8 with a malformed sequence every few characters
+    };
+
+    static const corpus_kind corpus_kinds[] = {
+        corpus_kind::ascii, corpus_kind::latin_1, corpus_kind::cjk,
+        corpus_kind::emoji, corpus_kind::invalid
+    };
+
+    // Input sizes for corpus cases, from 8 B to 64 MiB
+    static const size_t corpus_sizes[] = {
+        8, 256, 8 * 1024, 256 * 1024, 8 * 1024 * 1024, 64 * 1024 * 1024
+    };
+
+    inline const char *corpus_name(corpus_kind kind)
+    {
+        switch (kind) {
+        case corpus_kind::ascii:    return "ascii";
+        case corpus_kind::latin_1:  return "latin-1";
+        case corpus_kind::cjk:      return "cjk";
+        case corpus_kind::emoji:    return "emoji";
+        case corpus_kind::invalid:  return "invalid";
+        }
+        return "unknown";
+    }
+
+    class corpus_generator
+    {
+    public:
+        explicit corpus_generator(corpus_kind kind) : m_kind(kind), m_state(0x9E3779B97F4A7C15ULL) { }
+
+        // Generate exactly size bytes.  Valid corpora are cut at a code
+        // point boundary and padded with ASCII rather than ending with a
+        // truncated sequence.
+        std::string generate(size_t size)
+        {
+            std::string result;
+            result.reserve(size + 64);
+            size_t word = 0;
+            while (result.size() < size) {
+                append_word(result);
+                result += (++word % 12 == 0) ? '\n' : ' ';
+            }
+
+            size_t cut = size;
+            if (m_kind != corpus_kind::invalid) {
+                while (cut > 0 && (result[cut] & 0xC0) == 0x80)
+                    --cut;
+            }
+            result.resize(cut);
+            result.append(size - cut, 'x');
+            return result;
+        }
+
+    private:
+        corpus_kind m_kind;
+        uint64_t m_state;
+
+        uint32_t next(uint32_t range)
+        {
+            // xorshift64*
+            m_state ^= m_state >> 12;
+            m_state ^= m_state << 25;
+            m_state ^= m_state >> 27;
+            return static_cast<uint32_t>(((m_state * 0x2545F4914F6CDD1DULL) >> 32) % range);
+        }
+
+        static void append_utf8(std::string &out, char32_t ch)
+        {
+            if (ch < 0x80) {
+                out += static_cast<char>(ch);
+            } else if (ch < 0x800) {
+                out += static_cast<char>(0xC0 | (ch >> 6));
+                out += static_cast<char>(0x80 | (ch & 0x3F));
+            } else if (ch < 0x10000) {
+                out += static_cast<char>(0xE0 | (ch >> 12));
+                out += static_cast<char>(0x80 | ((ch >> 6) & 0x3F));
+                out += static_cast<char>(0x80 | (ch & 0x3F));
+            } else {
+                out += static_cast<char>(0xF0 | (ch >> 18));
+                out += static_cast<char>(0x80 | ((ch >> 12) & 0x3F));
+                out += static_cast<char>(0x80 | ((ch >> 6) & 0x3F));
+                out += static_cast<char>(0x80 | (ch & 0x3F));
+            }
+        }
+
+        char32_t ascii_letter()
+        {
+            const uint32_t pick = next(64);
+            if (pick < 52)
+                return (pick < 26) ? U'a' + pick : U'A' + (pick - 26);
+            return (pick < 62) ? U'0' + (pick - 52) : U".,"[pick - 62];
+        }
+
+        void append_invalid(std::string &out)
+        {
+            static const char *const bad_sequences[] = {
+                "\x80",                 // Stray continuation byte
+                "\xBF\xBF",
+                "\xC3",                 // Truncated 2-byte sequence
+                "\xE4\xB8",             // Truncated 3-byte sequence
+                "\xF0\x9F\x98",         // Truncated 4-byte sequence
+                "\xC0\x80",             // Overlong NUL
+                "\xE0\x80\xAF",         // Overlong '/'
+                "\xED\xA0\x80",         // UTF-16 surrogate
+                "\xF4\x90\x80\x80",     // Past U+10FFFF
+                "\xF5\x80\x80\x80",
+                "\xFE",                 // Never valid in UTF-8
+                "\xFF",
+            };
+            out += bad_sequences[next(sizeof(bad_sequences) / sizeof(bad_sequences[0]))];
+        }
+
+        void append_word(std::string &out)
+        {
+            const uint32_t length = 2 + next(8);
+            for (uint32_t i = 0; i < length; ++i) {
+                switch (m_kind) {
+                case corpus_kind::ascii:
+                    append_utf8(out, ascii_letter());
+                    break;
+                case corpus_kind::latin_1:
+                    if (next(10) < 3)
+                        append_utf8(out, 0xC0 + next(0x40));
+                    else
+                        append_utf8(out, ascii_letter());
+                    break;
+                case corpus_kind::cjk:
+                    if (next(10) < 8)
+                        append_utf8(out, 0x4E00 + next(0x5200));
+                    else if (next(2))
+                        append_utf8(out, 0x3041 + next(0x56));
+                    else
+                        append_utf8(out, ascii_letter());
+                    break;
+                case corpus_kind::emoji:
+                    if (next(10) < 3)
+                        append_utf8(out, 0x1F300 + next(0x350));
+                    else
+                        append_utf8(out, ascii_letter());
+                    break;
+                case corpus_kind::invalid:
+                    if (next(8) == 0) {
+                        append_invalid(out);
+                    } else {
+                        const uint32_t width = next(4);
+                        append_utf8(out, width == 0 ? ascii_letter()
+                                       : width == 1 ? 0xC0 + next(0x40)
+                                       : width == 2 ? 0x4E00 + next(0x5200)
+                                       : 0x1F300 + next(0x350));
+                    }
+                    break;
+                }
+            }
+        }
+    };
+
+    // A generated corpus along with the other representations benchmarks
+    // need as input.  Everything is built on first use, so cases excluded
+    // by --filter don't pay for generating large inputs.
+    class corpus
+    {
+    public:
+        corpus(corpus_kind kind, size_t size)
+            : m_kind(kind), m_size(size), m_have_bytes(), m_have_text(),
+              m_have_utf16(), m_have_utf32() { }
+
+        corpus_kind kind() const { return m_kind; }
+        size_t size() const { return m_size; }
+
+        const std::string &bytes()
+        {
+            if (!m_have_bytes) {
+                m_bytes = corpus_generator(m_kind).generate(m_size);
+                m_have_bytes = true;
+            }
+            return m_bytes;
+        }
+
+        const ST::string &text()
+        {
+            if (!m_have_text) {
+                m_text = ST::string::from_utf8(bytes().c_str(), bytes().size(),
+                                               ST::substitute_invalid);
+                m_have_text = true;
+            }
+            return m_text;
+        }
+
+        const ST::utf16_buffer &utf16()
+        {
+            if (!m_have_utf16) {
+                m_utf16 = text().to_utf16();
+                m_have_utf16 = true;
+            }
+            return m_utf16;
+        }
+
+        const ST::utf32_buffer &utf32()
+        {
+            if (!m_have_utf32) {
+                m_utf32 = text().to_utf32();
+                m_have_utf32 = true;
+            }
+            return m_utf32;
+        }
+
+    private:
+        corpus_kind m_kind;
+        size_t m_size;
+        std::string m_bytes;
+        ST::string m_text;
+        ST::utf16_buffer m_utf16;
+        ST::utf32_buffer m_utf32;
+        bool m_have_bytes, m_have_text, m_have_utf16, m_have_utf32;
+    };
+}
+
+#endif // _ST_PROFILE_CORPUS_H
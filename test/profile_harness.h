@@ -0,0 +1,292 @@
+/*  Copyright (c) 2026 Michael Hansen
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in
+    all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE. */
+
+// Minimal benchmark harness for string_profile.  Each case is warmed up,
+// calibrated to run for at least --min-time milliseconds per repetition,
+// and then repeated --repetitions times.  Results are reported as the
+// median and 99th percentile time per operation, along with throughput
+// for cases that process a known number of bytes, and can additionally
+// be written as JSON or CSV for comparison across builds.
+
+#ifndef _ST_PROFILE_HARNESS_H
+#define _ST_PROFILE_HARNESS_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "st_alloc_stats.h"
+#include "st_format.h"
+#include "st_stdio.h"
+
+namespace bench
+{
+    // Input sizes for throughput cases, from 16 B to 16 MiB
+    static const size_t sweep_sizes[] = {
+        16, 256, 4096, 64 * 1024, 1024 * 1024, 16 * 1024 * 1024
+    };
+
+    inline ST::string size_label(size_t size)
+    {
+        if (size >= 1024 * 1024 && (size % (1024 * 1024)) == 0)
+            return ST::format("{} MiB", size / (1024 * 1024));
+        if (size >= 1024 && (size % 1024) == 0)
+            return ST::format("{} KiB", size / 1024);
+        return ST::format("{} B", size);
+    }
+
+    struct result
+    {
+        ST::string name;
+        size_t bytes;
+        size_t iterations;
+        size_t repetitions;
+        double median_ns;
+        double p99_ns;
+
+        double mb_per_sec() const
+        {
+            return (bytes && median_ns > 0.0) ? (bytes * 1000.0) / median_ns : 0.0;
+        }
+    };
+
+    class harness
+    {
+    public:
+        harness()
+            : m_min_time_ms(10.0), m_repetitions(10), m_max_size(SIZE_MAX),
+              m_budget_failures() { }
+
+        // Returns false if the command line was invalid
+        bool parse_args(int argc, char *argv[])
+        {
+            for (int i = 1; i < argc; ++i) {
+                const char *arg = argv[i];
+                if (match_arg(arg, "--filter="))
+                    m_filter = arg + strlen("--filter=");
+                else if (match_arg(arg, "--json="))
+                    m_json_path = arg + strlen("--json=");
+                else if (match_arg(arg, "--csv="))
+                    m_csv_path = arg + strlen("--csv=");
+                else if (match_arg(arg, "--min-time="))
+                    m_min_time_ms = strtod(arg + strlen("--min-time="), nullptr);
+                else if (match_arg(arg, "--repetitions="))
+                    m_repetitions = strtoul(arg + strlen("--repetitions="), nullptr, 10);
+                else if (match_arg(arg, "--max-size="))
+                    m_max_size = strtoull(arg + strlen("--max-size="), nullptr, 10);
+                else
+                    return usage(argv[0]);
+            }
+            if (m_min_time_ms <= 0.0 || m_repetitions == 0 || m_max_size == 0)
+                return usage(argv[0]);
+            return true;
+        }
+
+        // Whether size-parameterized cases should be run for this size
+        bool size_enabled(size_t size) const { return size <= m_max_size; }
+
+        // Measure fun(), which processes bytes bytes per call (or 0 if
+        // the case has no meaningful throughput)
+        template <typename Code>
+        void run(const ST::string &name, size_t bytes, const Code &fun)
+        {
+            if (!m_filter.empty() && name.find(m_filter) < 0)
+                return;
+
+            // Warm up caches and lazy initialization, then scale the
+            // iteration count until one repetition takes long enough to
+            // time reliably
+            fun();
+            size_t iterations = 1;
+            double elapsed_ns;
+            for ( ;; ) {
+                elapsed_ns = time_ns(iterations, fun);
+                if (elapsed_ns >= m_min_time_ms * 1.0e6 || iterations >= max_iterations)
+                    break;
+                const double scale = (elapsed_ns > 0.0)
+                                   ? (m_min_time_ms * 1.2e6) / elapsed_ns : 10.0;
+                iterations = std::min(max_iterations,
+                        static_cast<size_t>(iterations * std::min(std::max(scale, 2.0), 10.0)));
+            }
+
+            // Don't let very slow cases take more than about a second
+            size_t repetitions = m_repetitions;
+            if (elapsed_ns * repetitions > 1.0e9)
+                repetitions = std::max<size_t>(3, static_cast<size_t>(1.0e9 / elapsed_ns));
+
+            std::vector<double> samples;
+            samples.reserve(repetitions);
+            for (size_t i = 0; i < repetitions; ++i)
+                samples.push_back(time_ns(iterations, fun) / iterations);
+            std::sort(samples.begin(), samples.end());
+
+            result res;
+            res.name = name;
+            res.bytes = bytes;
+            res.iterations = iterations;
+            res.repetitions = repetitions;
+            res.median_ns = (repetitions % 2) ? samples[repetitions / 2]
+                          : (samples[repetitions / 2 - 1] + samples[repetitions / 2]) / 2.0;
+            res.p99_ns = samples[std::min(repetitions - 1,
+                                 static_cast<size_t>(repetitions * 0.99))];
+            print_result(res);
+            m_results.push_back(std::move(res));
+        }
+
+        // Check that one call of fun() makes no more than max_allocations
+        // heap allocations.  Only meaningful when string_theory is built
+        // with ST_ENABLE_ALLOC_STATS; otherwise this does nothing.
+        template <typename Code>
+        void check_allocs(const ST::string &name, size_t max_allocations, const Code &fun)
+        {
+            if (!ST::alloc_stats::enabled())
+                return;
+            if (!m_filter.empty() && name.find(m_filter) < 0)
+                return;
+
+            const ST::alloc_stats before = ST::alloc_stats::snapshot();
+            fun();
+            const ST::alloc_stats stats = ST::alloc_stats::snapshot() - before;
+            const bool ok = stats.allocations <= max_allocations;
+            ST::printf("{36}: {4} allocs  {4} copies  budget {4}  {}\n", name,
+                       stats.allocations, stats.copies, max_allocations,
+                       ok ? "ok" : "FAILED");
+            if (!ok)
+                m_budget_failures += 1;
+        }
+
+        // Whether every check_allocs() case stayed within its budget
+        bool budgets_met() const { return m_budget_failures == 0; }
+
+        // Blank line between groups of related cases in the text output
+        void separator() const
+        {
+            if (m_filter.empty())
+                ST::printf("\n");
+        }
+
+        // Write any requested machine-readable reports.  Returns false if
+        // a report file could not be written.
+        bool write_reports() const
+        {
+            bool ok = true;
+            if (!m_json_path.empty())
+                ok = write_json(m_json_path) && ok;
+            if (!m_csv_path.empty())
+                ok = write_csv(m_csv_path) && ok;
+            return ok;
+        }
+
+    private:
+        // Cases the compiler optimizes away entirely never reach the
+        // minimum time; stop scaling them at some point
+        static constexpr size_t max_iterations = 1000000000;
+
+        double m_min_time_ms;
+        size_t m_repetitions;
+        size_t m_max_size;
+        size_t m_budget_failures;
+        ST::string m_filter;
+        ST::string m_json_path;
+        ST::string m_csv_path;
+        std::vector<result> m_results;
+
+        static bool match_arg(const char *arg, const char *prefix)
+        {
+            return strncmp(arg, prefix, strlen(prefix)) == 0;
+        }
+
+        static bool usage(const char *argv0)
+        {
+            ST::printf(stderr, "Usage: {} [--filter=TEXT] [--min-time=MS] [--repetitions=N]\n"
+                               "           [--max-size=BYTES] [--json=FILE] [--csv=FILE]\n", argv0);
+            return false;
+        }
+
+        template <typename Code>
+        static double time_ns(size_t iterations, const Code &fun)
+        {
+            auto clk = std::chrono::steady_clock::now();
+            for (size_t i = 0; i < iterations; ++i)
+                fun();
+            auto dur = std::chrono::steady_clock::now() - clk;
+            return std::chrono::duration<double, std::nano>(dur).count();
+        }
+
+        static void print_result(const result &res)
+        {
+            if (res.bytes) {
+                ST::printf("{36}: {12.1f} ns/op  p99 {12.1f}  {10.1f} MB/s\n",
+                           res.name, res.median_ns, res.p99_ns, res.mb_per_sec());
+            } else {
+                ST::printf("{36}: {12.1f} ns/op  p99 {12.1f}\n",
+                           res.name, res.median_ns, res.p99_ns);
+            }
+        }
+
+        static ST::string quote(const ST::string &text, bool csv)
+        {
+            if (csv)
+                return ST::format("\"{}\"", text.replace("\"", "\"\""));
+            return ST::format("\"{}\"", text.replace("\\", "\\\\").replace("\"", "\\\""));
+        }
+
+        bool write_json(const ST::string &path) const
+        {
+            FILE *out = fopen(path.c_str(), "w");
+            if (!out)
+                return false;
+
+            ST::printf(out, "{{\n  \"benchmarks\": [");
+            for (size_t i = 0; i < m_results.size(); ++i) {
+                const result &res = m_results[i];
+                ST::printf(out, "{}\n    {{\"name\": {}, \"bytes\": {}, \"iterations\": {}, "
+                           "\"repetitions\": {}, \"median_ns\": {.3f}, \"p99_ns\": {.3f}, "
+                           "\"mb_per_sec\": {.3f}}}",
+                           i ? "," : "", quote(res.name, false), res.bytes,
+                           res.iterations, res.repetitions, res.median_ns, res.p99_ns,
+                           res.mb_per_sec());
+            }
+            ST::printf(out, "\n  ]\n}}\n");
+            return fclose(out) == 0;
+        }
+
+        bool write_csv(const ST::string &path) const
+        {
+            FILE *out = fopen(path.c_str(), "w");
+            if (!out)
+                return false;
+
+            ST::printf(out, "name,bytes,iterations,repetitions,median_ns,p99_ns,mb_per_sec\n");
+            for (const result &res : m_results) {
+                ST::printf(out, "{},{},{},{},{.3f},{.3f},{.3f}\n",
+                           quote(res.name, true), res.bytes, res.iterations,
+                           res.repetitions, res.median_ns, res.p99_ns, res.mb_per_sec());
+            }
+            return fclose(out) == 0;
+        }
+    };
+}
+
+#endif // _ST_PROFILE_HARNESS_H
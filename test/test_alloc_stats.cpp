@@ -0,0 +1,154 @@
+/*  Copyright (c) 2026 Michael Hansen
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in
+    all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE. */
+
+#include "st_alloc_stats.h"
+#include "st_format.h"
+#include "st_stringstream.h"
+
+#include <gtest/gtest.h>
+#include <thread>
+
+// Heap traffic generated by running code on the calling thread
+template <typename Code>
+static ST::alloc_stats count_allocs(Code code)
+{
+    const ST::alloc_stats before = ST::alloc_stats::snapshot();
+    code();
+    return ST::alloc_stats::snapshot() - before;
+}
+
+static const char long_text[] =
+    "This string is long enough that it never fits in any inline storage, "
+    "regardless of how ST::buffer is configured.";
+
+TEST(alloc_stats, disabled)
+{
+    if (ST::alloc_stats::enabled())
+        GTEST_SKIP() << "Built with ST_ENABLE_ALLOC_STATS";
+
+    ST::alloc_stats stats = count_allocs([]() {
+        ST::string str = ST::string::from_utf8(long_text);
+        ST::string copy = str;
+        (void)copy;
+    });
+    EXPECT_EQ(0u, stats.allocations);
+    EXPECT_EQ(0u, stats.deallocations);
+    EXPECT_EQ(0u, stats.bytes);
+    EXPECT_EQ(0u, stats.sso_hits);
+    EXPECT_EQ(0u, stats.copies);
+}
+
+TEST(alloc_stats, string)
+{
+    if (!ST::alloc_stats::enabled())
+        GTEST_SKIP() << "Built without ST_ENABLE_ALLOC_STATS";
+
+    ST::alloc_stats stats = count_allocs([]() {
+        ST::string str = ST::string::from_utf8("Short");
+        EXPECT_EQ(5u, str.size());
+    });
+    EXPECT_EQ(0u, stats.allocations);
+    EXPECT_EQ(1u, stats.sso_hits);
+
+    stats = count_allocs([]() {
+        ST::string str = ST::string::from_utf8(long_text);
+        EXPECT_EQ(sizeof(long_text) - 1, str.size());
+    });
+    EXPECT_EQ(1u, stats.allocations);
+    EXPECT_EQ(1u, stats.deallocations);
+    EXPECT_EQ(sizeof(long_text), stats.bytes);
+    EXPECT_EQ(0u, stats.sso_hits);
+
+    const ST::string str = ST::string::from_utf8(long_text);
+    stats = count_allocs([&str]() {
+        ST::string copy = str;
+        ST::string moved = std::move(copy);
+        EXPECT_EQ(str, moved);
+    });
+    EXPECT_EQ(1u, stats.allocations);
+    EXPECT_EQ(1u, stats.deallocations);
+    EXPECT_EQ(1u, stats.copies);
+}
+
+TEST(alloc_stats, budgets)
+{
+    if (!ST::alloc_stats::enabled())
+        GTEST_SKIP() << "Built without ST_ENABLE_ALLOC_STATS";
+
+    // Short results are assembled on the stack and stored inline
+    ST::alloc_stats stats = count_allocs([]() {
+        ST::string result = ST::format("{} + {} = {}", 40, 2, 42);
+        EXPECT_EQ(ST_LITERAL("40 + 2 = 42"), result);
+    });
+    EXPECT_EQ(0u, stats.allocations);
+
+    const ST::string text = ST::string::from_utf8(long_text);
+    stats = count_allocs([&text]() {
+        ST::string result = ST::format("<{}>", text);
+        EXPECT_EQ(text.size() + 2, result.size());
+    });
+    EXPECT_EQ(1u, stats.allocations);
+    EXPECT_EQ(0u, stats.copies);
+
+    stats = count_allocs([]() {
+        std::vector<ST::string> parts = ST_LITERAL("a,bb,ccc,dddd").split(',');
+        EXPECT_EQ(4u, parts.size());
+    });
+    EXPECT_EQ(0u, stats.allocations);
+    EXPECT_EQ(0u, stats.copies);
+
+    stats = count_allocs([&text]() {
+        ST::string result = text.replace("string", "text");
+        EXPECT_EQ(text.size() - 2, result.size());
+    });
+    EXPECT_EQ(1u, stats.allocations);
+
+    stats = count_allocs([&text]() {
+        ST::string_stream ss;
+        for (int i = 0; i < 10; ++i)
+            ss << text;
+        ST::string result = ss.take_string();
+        EXPECT_EQ(text.size() * 10, result.size());
+    });
+    EXPECT_GE(3u, stats.allocations);
+    EXPECT_EQ(0u, stats.copies);
+    EXPECT_EQ(stats.allocations, stats.deallocations);
+}
+
+TEST(alloc_stats, per_thread)
+{
+    if (!ST::alloc_stats::enabled())
+        GTEST_SKIP() << "Built without ST_ENABLE_ALLOC_STATS";
+
+    ST::alloc_stats thread_stats;
+    ST::alloc_stats stats = count_allocs([&thread_stats]() {
+        std::thread worker([&thread_stats]() {
+            ST::alloc_stats::reset();
+            ST::string str = ST::string::from_utf8(long_text);
+            ST::string copy = str;
+            (void)copy;
+            thread_stats = ST::alloc_stats::snapshot();
+        });
+        worker.join();
+    });
+    EXPECT_EQ(0u, stats.allocations);
+    EXPECT_EQ(2u, thread_stats.allocations);
+    EXPECT_EQ(1u, thread_stats.copies);
+}
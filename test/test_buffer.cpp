@@ -99,6 +99,29 @@ TEST(char_buffer, utility)
     EXPECT_TRUE(ST::utf32_buffer().empty());
 }
 
+TEST(char_buffer, layout)
+{
+#if defined(ST_COMPACT_BUFFER)
+    EXPECT_EQ(sizeof(size_t) + ST_COMPACT_SSO_SIZE, sizeof(ST::char_buffer));
+    EXPECT_EQ(sizeof(size_t) + ST_COMPACT_SSO_SIZE, sizeof(ST::utf32_buffer));
+    EXPECT_EQ(sizeof(ST::char_buffer), sizeof(ST::string));
+#else
+    EXPECT_GE(size_t(ST_MAX_SSO_SIZE), sizeof(ST::char_buffer) - sizeof(size_t) - sizeof(char *));
+#endif
+
+    // Crossing the SSO boundary in both directions must preserve contents
+    ST::char_buffer buf("0123456789abcdef0123456789abcdef", 32);
+    ST::char_buffer small("abc", 3);
+    buf = small;
+    EXPECT_EQ(ST_CHAR_LITERAL("abc"), buf);
+    small = ST::char_buffer("0123456789abcdef0123456789abcdef", 32);
+    EXPECT_EQ(ST_CHAR_LITERAL("0123456789abcdef0123456789abcdef"), small);
+    buf = std::move(small);
+    EXPECT_EQ(ST_CHAR_LITERAL("0123456789abcdef0123456789abcdef"), buf);
+    EXPECT_TRUE(small.empty());
+    EXPECT_EQ(0, small.data()[0]);
+}
+
 TEST(char_buffer, stack_construction)
 {
     // If these change, this test may need to be updated to match
@@ -319,6 +342,37 @@ TEST(char_buffer, move)
 #   endif
 #endif
 
+TEST(char_buffer, release_adopt)
+{
+    ST::char_buffer cb1("Test", 4);
+    char *raw1 = cb1.release();
+    EXPECT_EQ(0, T_strcmp(raw1, "Test"));
+    EXPECT_TRUE(cb1.empty());
+    EXPECT_EQ(0, cb1.c_str()[0]);
+
+    ST::char_buffer cb2("0123456789abcdefghij0123456789abcdefghij", 40);
+    const char *heap = cb2.data();
+    char *raw2 = cb2.release();
+    EXPECT_EQ(heap, raw2);
+    EXPECT_EQ(0, T_strcmp(raw2, "0123456789abcdefghij0123456789abcdefghij"));
+    EXPECT_TRUE(cb2.empty());
+
+    ST::char_buffer dest;
+    dest.adopt(raw2, 40);
+    EXPECT_EQ(raw2, dest.data());
+    EXPECT_EQ(ST_CHAR_LITERAL("0123456789abcdefghij0123456789abcdefghij"), dest);
+
+    dest.adopt(raw1, 4);
+    EXPECT_EQ(ST_CHAR_LITERAL("Test"), dest);
+    EXPECT_EQ(4U, dest.size());
+
+    ST::wchar_buffer wcb(L"0123456789abcdefghij0123456789abcdefghij", 40);
+    wchar_t *wraw = wcb.release();
+    ST::wchar_buffer wdest;
+    wdest.adopt(wraw, 40);
+    EXPECT_EQ(ST_WCHAR_LITERAL("0123456789abcdefghij0123456789abcdefghij"), wdest);
+}
+
 TEST(char_buffer, self_assign)
 {
     // If this changes, this test may need to be updated to match
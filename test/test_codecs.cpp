@@ -23,6 +23,7 @@
 
 #include <gtest/gtest.h>
 #include <iostream>
+#include <cstring>
 
 namespace ST
 {
@@ -174,6 +175,68 @@ TEST(codecs, hex_decode_buffer)
     EXPECT_EQ(cbuf(data_17), ST::char_buffer(buffer, sizeof(data_17)));
 }
 
+TEST(codecs, hex_encode_upper)
+{
+    EXPECT_EQ(ST_LITERAL("000102030405060708090A0B0C0D0E0F10F0FF"),
+              ST::hex_encode(data_hex_ranges, sizeof(data_hex_ranges), true));
+    EXPECT_EQ(ST_LITERAL("0102030405060708090A0B0C0D0E0F1011"),
+              ST::hex_encode(cbuf(data_17), true));
+    EXPECT_EQ(cbuf(data_hex_ranges),
+              ST::hex_decode(ST_LITERAL("000102030405060708090A0B0C0D0E0F10F0FF")));
+}
+
+TEST(codecs, hex_encode_to)
+{
+    // Long enough to exercise any vectorized paths as well as the tails
+    unsigned char data[100];
+    char expected[sizeof(data) * 2 + 1];
+    for (size_t i = 0; i < sizeof(data); ++i) {
+        data[i] = static_cast<unsigned char>(i * 37);
+        snprintf(expected + i * 2, 3, "%02x", data[i]);
+    }
+
+    char output[sizeof(data) * 2 + 1];
+    for (size_t size = 0; size <= sizeof(data); ++size) {
+        memset(output, '#', sizeof(output));
+        EXPECT_EQ(size * 2, ST::hex_encode_to(output, data, size));
+        EXPECT_EQ(0, memcmp(expected, output, size * 2));
+        EXPECT_EQ('#', output[size * 2]);
+
+        char decoded[sizeof(data)];
+        EXPECT_EQ(static_cast<ST_ssize_t>(size),
+                  ST::hex_decode(output, size * 2, decoded, sizeof(decoded)));
+        EXPECT_EQ(0, memcmp(data, decoded, size));
+    }
+
+    // Bad characters in every position
+    for (size_t pos = 0; pos < sizeof(output) - 1; ++pos) {
+        ST::hex_encode_to(output, data, sizeof(data));
+        output[pos] = 'g';
+        char decoded[sizeof(data)];
+        EXPECT_EQ(-1, ST::hex_decode(output, sizeof(output) - 1, decoded, sizeof(decoded)));
+    }
+}
+
+TEST(codecs, hex_encode_records)
+{
+    static const unsigned char records[] = {
+        0x01, 0x23, 0x45, 0x67,
+        0x89, 0xAB, 0xCD, 0xEF,
+        0xDE, 0xAD, 0xBE, 0xEF,
+    };
+
+    char output[64];
+    EXPECT_EQ(24u, ST::hex_records_size(4, 3));
+    EXPECT_EQ(24u, ST::hex_encode_records(output, records, 4, 3));
+    EXPECT_EQ(ST_LITERAL("0123456789abcdefdeadbeef"), ST::string::from_utf8(output, 24));
+
+    EXPECT_EQ(27u, ST::hex_records_size(4, 3, '\n'));
+    EXPECT_EQ(27u, ST::hex_encode_records(output, records, 4, 3, '\n', true));
+    EXPECT_EQ(ST_LITERAL("01234567\n89ABCDEF\nDEADBEEF\n"), ST::string::from_utf8(output, 27));
+
+    EXPECT_EQ(0u, ST::hex_encode_records(output, records, 4, 0, '\n'));
+}
+
 TEST(codecs, hex_codec_errors)
 {
     EXPECT_THROW(ST::hex_encode(nullptr, 1), std::invalid_argument);
@@ -366,3 +429,148 @@ TEST(codecs, base64_codec_errors)
     char tight_buffer[3];
     EXPECT_EQ(-1, ST::base64_decode(ST_LITERAL("AQIDBA=="), tight_buffer, sizeof(tight_buffer)));
 }
+
+TEST(codecs, base64_url)
+{
+    EXPECT_EQ(ST_LITERAL("ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_"),
+              ST::base64_encode(data_base64_ranges, sizeof(data_base64_ranges),
+                                ST::base64_url));
+    EXPECT_EQ(cbuf(data_base64_ranges), ST::base64_decode(
+        ST_LITERAL("ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_"),
+        ST::base64_url));
+
+    EXPECT_EQ(ST_LITERAL("AQIDBAUGBwgJCgsMDQ4PEA=="),
+              ST::base64_encode(data_16, sizeof(data_16), ST::base64_url));
+    EXPECT_EQ(cbuf(data_16), ST::base64_decode(ST_LITERAL("AQIDBAUGBwgJCgsMDQ4PEA=="),
+                                               ST::base64_url));
+
+    // Each alphabet rejects the other's extra characters
+    EXPECT_THROW(ST::base64_decode(ST_LITERAL("++++"), ST::base64_url), ST::codec_error);
+    EXPECT_THROW(ST::base64_decode(ST_LITERAL("////"), ST::base64_url), ST::codec_error);
+    EXPECT_THROW(ST::base64_decode(ST_LITERAL("----"), ST::base64_standard), ST::codec_error);
+    EXPECT_THROW(ST::base64_decode(ST_LITERAL("____"), ST::base64_standard), ST::codec_error);
+}
+
+TEST(codecs, base64_unpadded)
+{
+    EXPECT_EQ(ST::string(), ST::base64_encode(data_empty, 0, ST::base64_url, false));
+    EXPECT_EQ(ST_LITERAL("AQ"), ST::base64_encode(data_1, sizeof(data_1),
+                                                  ST::base64_standard, false));
+    EXPECT_EQ(ST_LITERAL("AQI"), ST::base64_encode(data_2, sizeof(data_2),
+                                                   ST::base64_standard, false));
+    EXPECT_EQ(ST_LITERAL("AQID"), ST::base64_encode(data_3, sizeof(data_3),
+                                                    ST::base64_standard, false));
+    EXPECT_EQ(ST_LITERAL("AQIDBAUGBwgJCgsMDQ4PEBE"),
+              ST::base64_encode(data_17, sizeof(data_17), ST::base64_url, false));
+
+    EXPECT_EQ(cbuf(data_1), ST::base64_decode(ST_LITERAL("AQ"), ST::base64_standard));
+    EXPECT_EQ(cbuf(data_2), ST::base64_decode(ST_LITERAL("AQI"), ST::base64_standard));
+    EXPECT_EQ(cbuf(data_1), ST::base64_decode(ST_LITERAL("AQ=="), ST::base64_standard));
+    EXPECT_EQ(cbuf(data_17), ST::base64_decode(ST_LITERAL("AQIDBAUGBwgJCgsMDQ4PEBE"),
+                                               ST::base64_url));
+
+    char buffer[64];
+    EXPECT_EQ(2, ST::base64_decode(ST_LITERAL("AQI"), nullptr, 0, ST::base64_url));
+    EXPECT_EQ(2, ST::base64_decode(ST_LITERAL("AQI"), buffer, sizeof(buffer), ST::base64_url));
+    EXPECT_EQ(-1, ST::base64_decode(ST_LITERAL("AQIDB"), buffer, sizeof(buffer), ST::base64_url));
+    EXPECT_EQ(-1, ST::base64_decode(ST_LITERAL("AQ="), buffer, sizeof(buffer), ST::base64_url));
+    EXPECT_EQ(-1, ST::base64_decode(ST_LITERAL("A"), buffer, sizeof(buffer), ST::base64_url));
+
+    // The original overloads still require padding
+    EXPECT_THROW(ST::base64_decode(ST_LITERAL("AQ")), ST::codec_error);
+}
+
+TEST(codecs, base64_whitespace)
+{
+    EXPECT_EQ(cbuf(data_base64_ranges), ST::base64_decode(
+        ST_LITERAL("ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz\r\n"
+                   "0123456789+/\n"), ST::base64_standard, true));
+    EXPECT_EQ(cbuf(data_16), ST::base64_decode(ST_LITERAL(" AQ ID\tBAUG\nBwgJ CgsM DQ4P EA = = "),
+                                               ST::base64_standard, true));
+    EXPECT_EQ(cbuf(data_17), ST::base64_decode(ST_LITERAL("AQIDBAUGBwgJ\nCgsMDQ4PEBE\n"),
+                                               ST::base64_standard, true));
+    EXPECT_EQ(empty_buf, ST::base64_decode(ST_LITERAL(" \n "), ST::base64_standard, true));
+
+    EXPECT_THROW(ST::base64_decode(ST_LITERAL("AQID\nBA"), ST::base64_standard),
+                 ST::codec_error);
+    EXPECT_THROW(ST::base64_decode(ST_LITERAL("AQ==\nBA"), ST::base64_standard, true),
+                 ST::codec_error);
+    EXPECT_THROW(ST::base64_decode(ST_LITERAL("AQ===\n"), ST::base64_standard, true),
+                 ST::codec_error);
+    EXPECT_THROW(ST::base64_decode(ST_LITERAL("AQI=="), ST::base64_standard, true),
+                 ST::codec_error);
+    EXPECT_THROW(ST::base64_decode(ST_LITERAL("AQ="), ST::base64_standard, true),
+                 ST::codec_error);
+    EXPECT_THROW(ST::base64_decode(ST_LITERAL("A\nQIDB"), ST::base64_standard, true),
+                 ST::codec_error);
+    EXPECT_THROW(ST::base64_decode(ST_LITERAL("AQ!D"), ST::base64_standard, true),
+                 ST::codec_error);
+}
+
+TEST(codecs, base64_streaming)
+{
+    // Enough data to exercise any vectorized paths as well as the tails
+    unsigned char data[1000];
+    for (size_t i = 0; i < sizeof(data); ++i)
+        data[i] = static_cast<unsigned char>((i * 7919) >> 3);
+
+    for (auto alphabet : { ST::base64_standard, ST::base64_url }) {
+        const ST::string expected = ST::base64_encode(data, sizeof(data), alphabet);
+        EXPECT_EQ(cbuf(data), ST::base64_decode(expected, alphabet));
+
+        for (size_t chunk : { 1, 2, 3, 5, 16, 47, 1000 }) {
+            ST::base64_encoder encoder(alphabet);
+            ST::char_buffer encoded;
+            encoded.allocate(ST::base64_encoder::max_output_size(sizeof(data)) + 4);
+            size_t encoded_size = 0;
+            for (size_t pos = 0; pos < sizeof(data); pos += chunk) {
+                const size_t count = std::min(chunk, sizeof(data) - pos);
+                encoded_size += encoder.update(data + pos, count,
+                                               encoded.data() + encoded_size);
+            }
+            encoded_size += encoder.finish(encoded.data() + encoded_size);
+            EXPECT_EQ(expected, ST::string::from_utf8(encoded.data(), encoded_size));
+
+            ST::base64_decoder decoder(alphabet);
+            char decoded[sizeof(data) + 3];
+            ST_ssize_t decoded_size = 0;
+            for (size_t pos = 0; pos < expected.size(); pos += chunk) {
+                const size_t count = std::min(chunk, expected.size() - pos);
+                ST_ssize_t written = decoder.update(expected.c_str() + pos, count,
+                                                    decoded + decoded_size);
+                ASSERT_GE(written, 0);
+                decoded_size += written;
+            }
+            ST_ssize_t tail = decoder.finish(decoded + decoded_size);
+            ASSERT_GE(tail, 0);
+            decoded_size += tail;
+            EXPECT_EQ(cbuf(data), ST::char_buffer(decoded, decoded_size));
+        }
+    }
+
+    // Unpadded output, and decoding a final group with no padding
+    ST::base64_encoder encoder(ST::base64_url, false);
+    char encoded[16];
+    size_t encoded_size = encoder.update(data_2, 1, encoded);
+    encoded_size += encoder.update(data_2 + 1, 1, encoded + encoded_size);
+    EXPECT_EQ(0u, encoded_size);
+    encoded_size += encoder.finish(encoded);
+    EXPECT_EQ(ST_LITERAL("AQI"), ST::string::from_utf8(encoded, encoded_size));
+
+    ST::base64_decoder decoder(ST::base64_url);
+    char decoded[16];
+    EXPECT_EQ(0, decoder.update("AQ", 2, decoded));
+    EXPECT_EQ(0, decoder.update("I", 1, decoded));
+    EXPECT_EQ(2, decoder.finish(decoded));
+    EXPECT_EQ(cbuf(data_2), ST::char_buffer(decoded, 2));
+
+    // Errors stick until the decoder is reset
+    EXPECT_EQ(-1, decoder.update("AQ!D", 4, decoded));
+    EXPECT_EQ(-1, decoder.update("AQID", 4, decoded));
+    decoder.reset();
+    EXPECT_EQ(3, decoder.update("AQID", 4, decoded));
+    EXPECT_EQ(0, decoder.update("B", 1, decoded));
+    EXPECT_EQ(-1, decoder.finish(decoded));
+    EXPECT_EQ(3, decoder.update("AQID", 4, decoded));
+    EXPECT_EQ(0, decoder.finish(decoded));
+}
@@ -133,6 +133,7 @@ TEST(format, string_classes)
     // These should be handled just like normal const char* string params
     // (see above), so just need to test that the wrappers are working
     EXPECT_EQ(ST_LITERAL("xxTESTxx"), ST::format("xx{}xx", ST_LITERAL("TEST")));
+    EXPECT_EQ(ST_LITERAL("xx  TESTxx"), ST::format("xx{>6}xx", ST_LITERAL("TE") + "ST"));
 
 #if defined(ST_ENABLE_STL_STRINGS)
     EXPECT_EQ(ST_LITERAL("xxTESTxx"), ST::format("xx{}xx", std::string("TEST")));
@@ -1095,3 +1096,18 @@ TEST(format, custom_formatter)
     EXPECT_EQ(ST_LITERAL("xxTestStruct{3,1.5}xx"),
               ST::format("xx{}xx", TestStruct{3, 1.5}));
 }
+
+TEST(format, stored_formatter_ref)
+{
+    // make_formatter_ref owns a copy of its value, so the formatter stays
+    // usable after the argument it was built from is gone
+    ST::formatter_ref_t ref = ST::make_formatter_ref(
+            ST::string("A string long enough to need heap storage"));
+
+    _ST_PRIVATE::string_format_writer writer("<{}>");
+    ASSERT_TRUE(writer.next_format());
+    ref(writer.parse_format(), writer);
+    EXPECT_FALSE(writer.next_format());
+    EXPECT_EQ(ST_LITERAL("<A string long enough to need heap storage>"),
+              writer.to_string(true, ST::check_validity));
+}
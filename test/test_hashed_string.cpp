@@ -0,0 +1,156 @@
+/*  Copyright (c) 2026 Michael Hansen
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in
+    all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE. */
+
+#include "st_hashed_string.h"
+
+#include <gtest/gtest.h>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace ST
+{
+    // Teach GTest how to print an ST::string
+    static void PrintTo(const ST::string &str, std::ostream *os)
+    {
+        *os << "ST::string{\"" << str.c_str() << "\"}";
+    }
+}
+
+TEST(hashed_string, hash)
+{
+    const ST::hashed_string empty;
+    EXPECT_TRUE(empty.empty());
+    EXPECT_EQ(ST::hash()(ST::string()), empty.hash());
+
+    const ST::string text = ST_LITERAL("settings.display.resolution");
+    const ST::hashed_string key(text);
+    EXPECT_EQ(text, key.str());
+    EXPECT_EQ(text.size(), key.size());
+    EXPECT_STREQ(text.c_str(), key.c_str());
+    EXPECT_EQ(ST::hash()(text), key.hash());
+    EXPECT_EQ(ST::hash()(text), ST::hash()(key));
+    EXPECT_EQ(ST::hash()(text), std::hash<ST::hashed_string>()(key));
+
+    ST::string moved = text;
+    const ST::hashed_string moved_key(std::move(moved));
+    EXPECT_EQ(key.hash(), moved_key.hash());
+}
+
+TEST(hashed_string, move)
+{
+    const ST::hashed_string empty;
+    ST::hashed_string source(ST_LITERAL("a string long enough for heap storage"));
+    const size_t source_hash = source.hash();
+
+    ST::hashed_string target(std::move(source));
+    EXPECT_EQ(source_hash, target.hash());
+    EXPECT_TRUE(source.empty());
+    EXPECT_EQ(ST::hash()(source.str()), source.hash());
+    EXPECT_TRUE(source == empty);
+
+    source = std::move(target);
+    EXPECT_EQ(source_hash, source.hash());
+    EXPECT_EQ(ST_LITERAL("a string long enough for heap storage"), source.str());
+    EXPECT_TRUE(target.empty());
+    EXPECT_EQ(ST::hash()(target.str()), target.hash());
+    EXPECT_TRUE(target == empty);
+}
+
+TEST(hashed_string, compare)
+{
+    const ST::hashed_string a1(ST_LITERAL("alpha"));
+    const ST::hashed_string a2(ST::string("alpha"));
+    const ST::hashed_string b(ST_LITERAL("beta"));
+
+    EXPECT_TRUE(a1 == a2);
+    EXPECT_FALSE(a1 != a2);
+    EXPECT_TRUE(a1 != b);
+    EXPECT_TRUE(a1 < b);
+    EXPECT_FALSE(b < a1);
+    EXPECT_EQ(ST_LITERAL("alpha"), static_cast<const ST::string &>(a1));
+}
+
+namespace
+{
+    // ST::hash, counting how often a key is actually rehashed
+    struct counting_hash
+    {
+        typedef void is_transparent;
+
+        size_t *rehashed;
+
+        size_t operator()(const ST::string &str) const noexcept
+        {
+            ++*rehashed;
+            return ST::hash()(str);
+        }
+
+        size_t operator()(const ST::hashed_string &str) const noexcept
+        {
+            return ST::hash()(str);
+        }
+    };
+}
+
+TEST(hashed_string, cached_hash)
+{
+    // ST::hash has a dedicated overload for hashed_string, returning the
+    // cached value rather than converting to ST::string and rehashing
+    size_t (ST::hash::*cached)(const ST::hashed_string &) const noexcept = &ST::hash::operator();
+    const ST::hashed_string probe(ST_LITERAL("probe"));
+    EXPECT_EQ(probe.hash(), (ST::hash().*cached)(probe));
+
+    size_t rehashed = 0;
+    std::unordered_map<ST::string, int, counting_hash, ST::equal>
+            map(8, counting_hash{&rehashed});
+    map[ST_LITERAL("alpha")] = 1;
+    map[ST_LITERAL("beta")] = 2;
+
+    const ST::hashed_string key(ST_LITERAL("beta"));
+    rehashed = 0;
+    EXPECT_EQ(2, map.find(key)->second);
+#if defined(__cpp_lib_generic_unordered_lookup)
+    // Heterogeneous lookup hashes the probe with the cached value
+    EXPECT_EQ(0U, rehashed);
+#else
+    // Without heterogeneous lookup, find() converts the key to ST::string
+    EXPECT_EQ(1U, rehashed);
+#endif
+}
+
+TEST(hashed_string, lookup)
+{
+    std::unordered_map<ST::string, int, ST::hash, ST::equal> first, second;
+    first[ST_LITERAL("alpha")] = 1;
+    second[ST_LITERAL("alpha")] = 2;
+    second[ST_LITERAL("beta")] = 3;
+
+    const ST::hashed_string key(ST_LITERAL("alpha"));
+    EXPECT_EQ(1, first.find(key)->second);
+    EXPECT_EQ(2, second.find(key)->second);
+    EXPECT_EQ(first.end(), first.find(ST::hashed_string(ST_LITERAL("beta"))));
+
+    std::unordered_set<ST::hashed_string> keys;
+    keys.insert(key);
+    keys.insert(ST::hashed_string(ST_LITERAL("alpha")));
+    keys.insert(ST::hashed_string(ST_LITERAL("beta")));
+    EXPECT_EQ(2U, keys.size());
+    EXPECT_EQ(1U, keys.count(ST::hashed_string(ST_LITERAL("beta"))));
+}
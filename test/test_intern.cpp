@@ -0,0 +1,94 @@
+/*  Copyright (c) 2026 Michael Hansen
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in
+    all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE. */
+
+#include "st_intern_pool.h"
+
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+
+TEST(intern_pool, empty)
+{
+    ST::intern_pool pool;
+    ST::interned_string def;
+    EXPECT_TRUE(def.empty());
+    EXPECT_EQ(0U, def.size());
+    EXPECT_STREQ("", def.c_str());
+
+    EXPECT_EQ(def, pool.intern(ST::string()));
+    EXPECT_EQ(def, pool.intern(""));
+    EXPECT_EQ(def, pool.intern(nullptr));
+    EXPECT_EQ(0U, pool.size());
+}
+
+TEST(intern_pool, canonical)
+{
+    ST::intern_pool pool;
+    ST::interned_string a1 = pool.intern(ST_LITERAL("metric.name"));
+    ST::interned_string a2 = pool.intern("metric.name");
+    ST::interned_string a3 = pool.intern(ST::string("metric.name.extra").left(11));
+    ST::interned_string b = pool.intern(ST_LITERAL("metric.other"));
+
+    EXPECT_EQ(a1, a2);
+    EXPECT_EQ(a1, a3);
+    EXPECT_NE(a1, b);
+    EXPECT_EQ(&a1.str(), &a2.str());
+    EXPECT_EQ(a1.c_str(), a3.c_str());
+    EXPECT_EQ(ST_LITERAL("metric.name"), a1.str());
+    EXPECT_EQ(ST_LITERAL("metric.other"), static_cast<const ST::string &>(b));
+    EXPECT_EQ(std::hash<ST::interned_string>()(a1), std::hash<ST::interned_string>()(a2));
+    EXPECT_EQ(2U, pool.size());
+}
+
+TEST(intern_pool, validation)
+{
+    ST::intern_pool pool;
+    EXPECT_THROW((void)pool.intern("bad\xff", ST_AUTO_SIZE, ST::check_validity),
+                 ST::unicode_error);
+    EXPECT_EQ(0U, pool.size());
+
+    ST::interned_string fixed = pool.intern("bad\xff", ST_AUTO_SIZE, ST::substitute_invalid);
+    EXPECT_EQ(ST_LITERAL("bad\xef\xbf\xbd"), fixed.str());
+    EXPECT_EQ(fixed, pool.intern("bad\xef\xbf\xbd"));
+    EXPECT_EQ(1U, pool.size());
+}
+
+TEST(intern_pool, threads)
+{
+    ST::intern_pool pool(4);
+    const size_t key_count = 200;
+    std::vector<std::vector<ST::interned_string>> results(4);
+
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < results.size(); ++t) {
+        threads.emplace_back([&pool, &results, t, key_count]() {
+            for (size_t i = 0; i < key_count; ++i)
+                results[t].push_back(pool.intern(ST::string::from_uint(i)));
+        });
+    }
+    for (auto &thread : threads)
+        thread.join();
+
+    EXPECT_EQ(key_count, pool.size());
+    for (size_t t = 1; t < results.size(); ++t) {
+        for (size_t i = 0; i < key_count; ++i)
+            EXPECT_EQ(results[0][i], results[t][i]);
+    }
+}
@@ -22,6 +22,7 @@
 
 #include <gtest/gtest.h>
 #include <sstream>
+#include <iomanip>
 
 /* This file does not extensively test formatting, as that is already tested
    by test_format.cpp.  Instead, this just tests the interfaces provided
@@ -47,6 +48,40 @@ TEST(stdio, writef_wide)
     EXPECT_EQ(sstream.str(), L"xxxxxTesting ###formatted output");
 }
 
+TEST(stdio, writef_long)
+{
+    // Exercise the chunked padding and transcoding paths
+    std::stringstream sstream;
+    ST::writef(sstream, "{>100}|", "x");
+    EXPECT_EQ(std::string(99, ' ') + "x|", sstream.str());
+
+    ST::string long_str;
+    std::wstring expected;
+    for (size_t i = 0; i < 300; ++i) {
+        long_str += ST_LITERAL("a\xe2\x82\xac");
+        expected += L"a\u20ac";
+    }
+    std::wstringstream wstream;
+    ST::writef(wstream, "{}{<100__}|", long_str, "y");
+    EXPECT_EQ(expected + L"y" + std::wstring(99, L'_') + L"|", wstream.str());
+
+    std::wstringstream wstream2;
+    wstream2 << long_str;
+    EXPECT_EQ(expected, wstream2.str());
+}
+
+TEST(stdio, stream_padding)
+{
+    std::stringstream sstream;
+    sstream << std::setw(8) << ST_LITERAL("abc") << "|"
+            << std::left << std::setw(6) << ST_LITERAL("de") << "|";
+    EXPECT_EQ("     abc|de    |", sstream.str());
+
+    std::wstringstream wstream;
+    wstream << std::setw(8) << ST_LITERAL("abc") << L"|" << ST_LITERAL("de");
+    EXPECT_EQ(L"     abc|de", wstream.str());
+}
+
 TEST(stdio, stream_ops)
 {
     std::stringstream sstream;
@@ -74,3 +109,82 @@ TEST(stdio, stream_ops_wide)
     EXPECT_EQ(ST_LITERAL("xxxxx"), x);
     EXPECT_EQ(ST_LITERAL("yyyyy"), y);
 }
+
+TEST(stdio, stream_extract)
+{
+    ST::string long_str = ST::string::fill(600, 'x');
+    std::stringstream sstream;
+    sstream << "  \t" << long_str << "\n\xe2\x82\xac  abcdef";
+
+    ST::string x, y, z;
+    sstream >> x >> y;
+    EXPECT_EQ(long_str, x);
+    EXPECT_EQ(ST_LITERAL("\xe2\x82\xac"), y);
+    EXPECT_TRUE(sstream.good());
+
+    sstream >> std::setw(3) >> z;
+    EXPECT_EQ(ST_LITERAL("abc"), z);
+    sstream >> z;
+    EXPECT_EQ(ST_LITERAL("def"), z);
+    EXPECT_TRUE(sstream.eof());
+    EXPECT_FALSE(sstream.fail());
+
+    sstream >> z;
+    EXPECT_TRUE(sstream.fail());
+    EXPECT_EQ(ST_LITERAL("def"), z);
+}
+
+TEST(stdio, stream_extract_invalid)
+{
+    if (ST_DEFAULT_VALIDATION != ST::check_validity)
+        GTEST_SKIP() << "Invalid UTF-8 is accepted by default";
+
+    // An invalid token is consumed and sets failbit, so an extraction
+    // loop ends instead of retrying it forever
+    std::stringstream sstream;
+    sstream << "abc \xff\xfe def\n\xc3;ghi";
+
+    ST::string token;
+    int tokens = 0;
+    while (sstream >> token && tokens < 10)
+        ++tokens;
+    EXPECT_EQ(1, tokens);
+    EXPECT_EQ(ST_LITERAL("abc"), token);
+    EXPECT_TRUE(sstream.fail());
+    EXPECT_FALSE(sstream.bad());
+
+    sstream.clear();
+    sstream >> token;
+    EXPECT_EQ(ST_LITERAL("def"), token);
+
+    sstream.ignore();
+    EXPECT_FALSE(ST::getline(sstream, token, ';'));
+    sstream.clear();
+    EXPECT_TRUE(ST::getline(sstream, token));
+    EXPECT_EQ(ST_LITERAL("ghi"), token);
+}
+
+TEST(stdio, getline)
+{
+    std::stringstream sstream;
+    sstream << "first line\n\nthird;line";
+
+    ST::string line;
+    EXPECT_TRUE(ST::getline(sstream, line));
+    EXPECT_EQ(ST_LITERAL("first line"), line);
+    EXPECT_TRUE(ST::getline(sstream, line));
+    EXPECT_EQ(ST_LITERAL(""), line);
+    EXPECT_TRUE(ST::getline(sstream, line, ';'));
+    EXPECT_EQ(ST_LITERAL("third"), line);
+    EXPECT_TRUE(ST::getline(sstream, line));
+    EXPECT_EQ(ST_LITERAL("line"), line);
+    EXPECT_TRUE(sstream.eof());
+    EXPECT_FALSE(ST::getline(sstream, line));
+
+    std::wstringstream wstream;
+    wstream << L"wide\nline";
+    EXPECT_TRUE(ST::getline(wstream, line));
+    EXPECT_EQ(ST_LITERAL("wide"), line);
+    EXPECT_TRUE(ST::getline(wstream, line));
+    EXPECT_EQ(ST_LITERAL("line"), line);
+}
@@ -0,0 +1,84 @@
+/*  Copyright (c) 2026 Michael Hansen
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in
+    all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE. */
+
+#include "st_keyword_map.h"
+#include "st_format.h"
+
+#include <gtest/gtest.h>
+#include <vector>
+
+TEST(keyword_map, find)
+{
+    static const char *const methods[] = {
+        "GET", "HEAD", "POST", "PUT", "DELETE", "CONNECT", "OPTIONS", "TRACE", "PATCH"
+    };
+    const ST::keyword_map<9> map(methods);
+    EXPECT_EQ(9U, map.size());
+
+    for (size_t i = 0; i < 9; ++i) {
+        EXPECT_EQ(static_cast<ST_ssize_t>(i), map.find(methods[i]));
+        EXPECT_EQ(static_cast<ST_ssize_t>(i), map.find(ST::string(methods[i])));
+        EXPECT_STREQ(methods[i], map.keyword(i));
+    }
+
+    EXPECT_EQ(-1, map.find("get"));
+    EXPECT_EQ(-1, map.find("GETS"));
+    EXPECT_EQ(-1, map.find(""));
+    EXPECT_EQ(-1, map.find(static_cast<const char *>(nullptr)));
+    EXPECT_EQ(2, map.find("POST /index.html", 4));
+    EXPECT_THROW((void)map.keyword(9), std::out_of_range);
+
+#if defined(ST_ENABLE_STL_STRINGS)
+    EXPECT_EQ(3, map.find(std::string("PUT")));
+#if defined(ST_HAVE_CXX17_STRING_VIEW)
+    EXPECT_EQ(4, map.find(std::string_view("DELETE")));
+#endif
+#endif
+}
+
+TEST(keyword_map, single)
+{
+    static const char *const keywords[] = { "" };
+    const ST::keyword_map<1> map(keywords);
+    EXPECT_EQ(0, map.find(""));
+    EXPECT_EQ(-1, map.find("x"));
+}
+
+TEST(keyword_map, large)
+{
+    std::vector<ST::string> storage;
+    storage.reserve(500);
+    const char *keywords[500];
+    for (size_t i = 0; i < 500; ++i) {
+        storage.push_back(ST::format("header-{}", i));
+        keywords[i] = storage.back().c_str();
+    }
+
+    const ST::keyword_map<500> map(keywords);
+    for (size_t i = 0; i < 500; ++i)
+        EXPECT_EQ(static_cast<ST_ssize_t>(i), map.find(storage[i]));
+    EXPECT_EQ(-1, map.find("header-500"));
+}
+
+TEST(keyword_map, duplicates)
+{
+    static const char *const keywords[] = { "a", "b", "a" };
+    EXPECT_THROW(ST::keyword_map<3> map(keywords), std::invalid_argument);
+}
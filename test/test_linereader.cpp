@@ -0,0 +1,127 @@
+/*  Copyright (c) 2026 Michael Hansen
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in
+    all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE. */
+
+#include "st_linereader.h"
+
+#include <gtest/gtest.h>
+
+namespace ST
+{
+    // Teach GTest how to print an ST::string
+    static void PrintTo(const ST::string &str, std::ostream *os)
+    {
+        *os << "ST::string{\"" << str.c_str() << "\"}";
+    }
+}
+
+#if defined(_MSC_VER)
+#   pragma warning(disable: 4996)
+#endif
+
+static void write_test_file(const char *data, size_t size)
+{
+    FILE *test_f = fopen("st_test.out", "wb");
+    ST_ASSERT(test_f, "Could not open output file for test");
+    fwrite(data, sizeof(char), size, test_f);
+    fclose(test_f);
+}
+
+TEST(line_reader, lines)
+{
+    static const char text[] = "first\n\nthird line\nno newline";
+    write_test_file(text, sizeof(text) - 1);
+
+    FILE *test_f = fopen("st_test.out", "rb");
+    ST_ASSERT(test_f, "Could not open output file for test");
+
+    // Use a tiny block to exercise refilling and growing the buffer
+    ST::line_reader reader(test_f, ST_DEFAULT_VALIDATION, 4);
+    ST::string line;
+    EXPECT_TRUE(reader.next(line));
+    EXPECT_EQ(ST_LITERAL("first"), line);
+    EXPECT_TRUE(reader.next());
+    EXPECT_EQ(0U, reader.size());
+    EXPECT_TRUE(reader.next());
+    EXPECT_EQ(10U, reader.size());
+    EXPECT_EQ(0, memcmp("third line", reader.data(), reader.size()));
+    EXPECT_TRUE(reader.next(line));
+    EXPECT_EQ(ST_LITERAL("no newline"), line);
+    EXPECT_FALSE(reader.next());
+    EXPECT_FALSE(reader.next());
+    fclose(test_f);
+
+    write_test_file("", 0);
+    test_f = fopen("st_test.out", "rb");
+    ST::line_reader empty_reader(test_f);
+    EXPECT_FALSE(empty_reader.next());
+    fclose(test_f);
+}
+
+TEST(line_reader, large)
+{
+    ST::string expected[100];
+    ST::string contents;
+    for (size_t i = 0; i < 100; ++i) {
+        expected[i] = ST::string::fill(i * 37, 'a' + (i % 26)) + ST_LITERAL("\xe2\x82\xac");
+        contents += expected[i] + ST_LITERAL("\n");
+    }
+    write_test_file(contents.c_str(), contents.size());
+
+    FILE *test_f = fopen("st_test.out", "rb");
+    ST_ASSERT(test_f, "Could not open output file for test");
+    ST::line_reader reader(test_f, ST::check_validity, 256);
+    ST::string line;
+    size_t count = 0;
+    while (reader.next(line)) {
+        ASSERT_GT(100U, count);
+        EXPECT_EQ(expected[count], line);
+        ++count;
+    }
+    EXPECT_EQ(100U, count);
+    fclose(test_f);
+}
+
+TEST(line_reader, validation)
+{
+    static const char text[] = "good\nbad\xff\nalso good\n";
+    write_test_file(text, sizeof(text) - 1);
+
+    FILE *test_f = fopen("st_test.out", "rb");
+    ST_ASSERT(test_f, "Could not open output file for test");
+    ST::line_reader reader(test_f, ST::check_validity);
+    ST::string line;
+    EXPECT_TRUE(reader.next(line));
+    EXPECT_EQ(ST_LITERAL("good"), line);
+    EXPECT_THROW(reader.next(line), ST::unicode_error);
+    fclose(test_f);
+
+    test_f = fopen("st_test.out", "rb");
+    ST_ASSERT(test_f, "Could not open output file for test");
+    ST::line_reader sub_reader(test_f, ST::substitute_invalid);
+    EXPECT_TRUE(sub_reader.next(line));
+    EXPECT_EQ(ST_LITERAL("good"), line);
+    EXPECT_TRUE(sub_reader.next(line));
+    EXPECT_EQ(ST_LITERAL("bad\xef\xbf\xbd"), line);
+    EXPECT_EQ(4U, sub_reader.size());
+    EXPECT_TRUE(sub_reader.next(line));
+    EXPECT_EQ(ST_LITERAL("also good"), line);
+    EXPECT_FALSE(sub_reader.next(line));
+    fclose(test_f);
+}
@@ -21,6 +21,7 @@
 #include "st_stringstream.h"
 
 #include <gtest/gtest.h>
+#include <vector>
 
 namespace ST
 {
@@ -31,6 +32,10 @@ namespace ST
     }
 }
 
+// A configured stack size of 0 is rounded up to 1
+static const size_t stack_size = (ST_STRING_STREAM_STACK_SIZE > 0)
+                               ? ST_STRING_STREAM_STACK_SIZE : 1;
+
 TEST(string_stream, empty)
 {
     ST::string_stream ss;
@@ -81,8 +86,8 @@ TEST(string_stream, append)
     EXPECT_EQ(ST_LITERAL("aaaaabbbbbbbbbb"), ss2.to_string());
 
     // Cause a heap allocation
-    ST::string s1 = ST::string::fill(ST_STACK_STRING_SIZE / 2, 'x');
-    ST::string s2 = ST::string::fill(ST_STACK_STRING_SIZE / 2, 'y');
+    ST::string s1 = ST::string::fill(stack_size / 2, 'x');
+    ST::string s2 = ST::string::fill(stack_size / 2, 'y');
     ST::string s3 = ST_LITERAL("z");
     ST::string_stream ss3;
     ss3.append(s1.c_str(), s1.size());
@@ -91,7 +96,7 @@ TEST(string_stream, append)
     EXPECT_EQ(s1.size() + s2.size() + s3.size(), ss3.size());
     EXPECT_EQ(s1 + s2 + s3, ss3.to_string());
 
-    ST::string s4 = ST::string::fill(ST_STACK_STRING_SIZE * 4, 'x');
+    ST::string s4 = ST::string::fill(stack_size * 4, 'x');
     ST::string_stream ss4;
     ss4.append(s3.c_str(), s3.size());
     ss4.append(s4.c_str(), s4.size());
@@ -112,23 +117,91 @@ TEST(string_stream, append_char)
 
     // Cause a heap allocation
     ST::string_stream ss2;
-    ss2.append_char('x', ST_STACK_STRING_SIZE / 2);
-    ss2.append_char('y', ST_STACK_STRING_SIZE / 2);
+    ss2.append_char('x', stack_size / 2);
+    ss2.append_char('y', stack_size / 2);
     ss2.append_char('z');
-    ST::string s1 = ST::string::fill(ST_STACK_STRING_SIZE / 2, 'x');
-    ST::string s2 = ST::string::fill(ST_STACK_STRING_SIZE / 2, 'y');
+    ST::string s1 = ST::string::fill(stack_size / 2, 'x');
+    ST::string s2 = ST::string::fill(stack_size / 2, 'y');
     ST::string s3 = ST_LITERAL("z");
     EXPECT_EQ(s1.size() + s2.size() + s3.size(), ss2.size());
     EXPECT_EQ(s1 + s2 + s3, ss2.to_string());
 
     ST::string_stream ss3;
     ss3.append_char('z');
-    ss3.append_char('x', ST_STACK_STRING_SIZE * 4);
-    ST::string s4 = ST::string::fill(ST_STACK_STRING_SIZE * 4, 'x');
+    ss3.append_char('x', stack_size * 4);
+    ST::string s4 = ST::string::fill(stack_size * 4, 'x');
     EXPECT_EQ(s3.size() + s4.size(), ss3.size());
     EXPECT_EQ(s3 + s4, ss3.to_string());
 }
 
+TEST(string_stream, reserve)
+{
+    ST::string_stream ss;
+    EXPECT_EQ(stack_size, ss.capacity());
+    ss << "abc";
+    const size_t reserved = stack_size * 4 + 64;
+    ss.reserve(reserved);
+    EXPECT_EQ(reserved, ss.capacity());
+    EXPECT_EQ(ST_LITERAL("abc"), ss.to_string());
+
+    const char *heap = ss.raw_buffer();
+    ss.append_char('x', stack_size * 2);
+    EXPECT_EQ(heap, ss.raw_buffer());
+
+    // Reserving less than the current capacity has no effect
+    ss.reserve(10);
+    EXPECT_EQ(reserved, ss.capacity());
+
+    ST::string_stream moved(std::move(ss));
+    EXPECT_EQ(heap, moved.raw_buffer());
+    EXPECT_EQ(0U, ss.size());
+    ss << "reuse";
+    EXPECT_EQ(ST_LITERAL("reuse"), ss.to_string());
+}
+
+TEST(string_stream, take_string)
+{
+    ST::string_stream ss;
+    ss << "Short";
+    EXPECT_EQ(ST_LITERAL("Short"), ss.take_string());
+    EXPECT_EQ(0U, ss.size());
+
+    ST::string s1 = ST::string::fill(stack_size * 2 + 63, 'x');
+    ss << s1;
+    const char *heap = ss.raw_buffer();
+    ST::string result = ss.take_string();
+    EXPECT_EQ(s1, result);
+    EXPECT_EQ(heap, result.c_str());
+    EXPECT_EQ(0U, ss.size());
+    EXPECT_EQ(stack_size, ss.capacity());
+
+    // Filled exactly to capacity, so the terminator needs more room
+    ss.reserve(stack_size * 2);
+    ss.append_char('y', stack_size * 2);
+    EXPECT_EQ(ST::string::fill(stack_size * 2, 'y'), ss.take_string());
+
+    ss.append_char('z', stack_size * 2);
+    ss << "\xff";
+    EXPECT_THROW((void)ss.take_string(ST::check_validity), ST::unicode_error);
+    EXPECT_EQ(0U, ss.size());
+
+    ss.append_char('z', stack_size * 2);
+    ss << "\xff";
+    ST::string fixed = ss.take_string(ST::substitute_invalid);
+    EXPECT_EQ(ST::string::fill(stack_size * 2, 'z') + ST_LITERAL("\xef\xbf\xbd"),
+              fixed);
+
+    // A mostly unused block is copied from, and kept for reuse
+    ss.reserve(stack_size * 8);
+    heap = ss.raw_buffer();
+    ss.append_char('w', stack_size * 2);
+    result = ss.take_string();
+    EXPECT_EQ(ST::string::fill(stack_size * 2, 'w'), result);
+    EXPECT_NE(heap, result.c_str());
+    EXPECT_EQ(heap, ss.raw_buffer());
+    EXPECT_EQ(0U, ss.size());
+}
+
 TEST(string_stream, to_string)
 {
     const char latin1[] = "\x20\x7e\xa0\xff";
@@ -180,15 +253,15 @@ TEST(string_stream, cat_strings)
     EXPECT_EQ(ST_LITERAL("aaaaabbbbbbbbbb"), ss2.to_string());
 
     // Cause a heap allocation
-    ST::string s1 = ST::string::fill(ST_STACK_STRING_SIZE / 2, 'x');
-    ST::string s2 = ST::string::fill(ST_STACK_STRING_SIZE / 2, 'y');
+    ST::string s1 = ST::string::fill(stack_size / 2, 'x');
+    ST::string s2 = ST::string::fill(stack_size / 2, 'y');
     ST::string s3 = ST_LITERAL("z");
     ST::string_stream ss3;
     ss3 << s1 << s2 << s3;
     EXPECT_EQ(s1.size() + s2.size() + s3.size(), ss3.size());
     EXPECT_EQ(s1 + s2 + s3, ss3.to_string());
 
-    ST::string s4 = ST::string::fill(ST_STACK_STRING_SIZE * 4, 'x');
+    ST::string s4 = ST::string::fill(stack_size * 4, 'x');
     ST::string_stream ss4;
     ss4 << s3 << s4;
     EXPECT_EQ(s3.size() + s4.size(), ss4.size());
@@ -323,3 +396,19 @@ TEST(string_stream, erase)
     EXPECT_EQ(0U, ss.size());
     EXPECT_EQ(ST::string(), ss.to_string());
 }
+
+TEST(string_stream, join_to)
+{
+    const std::vector<ST::string> items {
+        ST_LITERAL("one"), ST_LITERAL("two"), ST_LITERAL("three")
+    };
+
+    ST::string_stream ss;
+    ss << ST_LITERAL("[");
+    ST::join_to(ss, items, ST_LITERAL(", ")) << ST_LITERAL("]");
+    EXPECT_EQ(ST_LITERAL("[one, two, three]"), ss.to_string());
+
+    ST::string_stream empty;
+    ST::join_to(empty, std::vector<ST::string>(), ST_LITERAL(", "));
+    EXPECT_EQ(0U, empty.size());
+}
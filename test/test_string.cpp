@@ -19,6 +19,7 @@
     DEALINGS IN THE SOFTWARE. */
 
 #include "st_string.h"
+#include "st_codepoints.h"
 #include "st_assert.h"
 
 #include <gtest/gtest.h>
@@ -26,6 +27,8 @@
 #include <cmath>
 #include <limits>
 #include <iostream>
+#include <map>
+#include <unordered_map>
 
 #ifdef _MSC_VER
 #   pragma warning(disable: 4996)
@@ -220,6 +223,20 @@ TEST(string, move)
     EXPECT_EQ(24U, dest2.size());
 }
 
+TEST(string, release_buffer)
+{
+    ST::string s1("0123456789abcdefghij0123456789abcdefghij");
+    const char *heap = s1.c_str();
+    ST::char_buffer buffer = s1.release_buffer();
+    EXPECT_EQ(heap, buffer.data());
+    EXPECT_EQ(ST_CHAR_LITERAL("0123456789abcdefghij0123456789abcdefghij"), buffer);
+    EXPECT_TRUE(s1.empty());
+
+    ST::string s2("Test");
+    EXPECT_EQ(ST_CHAR_LITERAL("Test"), s2.release_buffer());
+    EXPECT_TRUE(s2.empty());
+}
+
 TEST(string, conv_utf8)
 {
     // From UTF-16 to UTF-8
@@ -485,6 +502,259 @@ TEST(string, validation)
     EXPECT_EQ(0, T_strcmp(junk, ST::string::from_utf8(junk, ST_AUTO_SIZE, ST::assume_valid).c_str()));
 }
 
+TEST(string, validation_range)
+{
+    // Four-byte sequences can encode up to U+1FFFFF, but anything past
+    // U+10FFFF is invalid, and can't be converted to UTF-16
+    const auto replacement4r = ST_LITERAL("\xef\xbf\xbd\xef\xbf\xbd\xef\xbf\xbd\xef\xbf\xbdx");
+    EXPECT_THROW({ (void)ST::string::from_utf8("\xF4\x90\x80\x80", ST_AUTO_SIZE, ST::check_validity); }, ST::unicode_error);
+    EXPECT_THROW({ (void)ST::string::from_utf8("\xF5\x80\x80\x80", ST_AUTO_SIZE, ST::check_validity); }, ST::unicode_error);
+    EXPECT_THROW({ (void)ST::string::from_utf8("\xF7\xBF\xBF\xBF", ST_AUTO_SIZE, ST::check_validity); }, ST::unicode_error);
+    EXPECT_EQ(replacement4r, ST::string::from_utf8("\xF4\x90\x80\x80x", ST_AUTO_SIZE, ST::substitute_invalid));
+    EXPECT_EQ(replacement4r, ST::string::from_utf8("\xF5\x80\x80\x80x", ST_AUTO_SIZE, ST::substitute_invalid));
+    EXPECT_EQ(ST_LITERAL("\xf4\x8f\xbf\xbfx"),
+              ST::string::from_utf8("\xF4\x8F\xBF\xBFx", ST_AUTO_SIZE, ST::check_validity));
+
+    // ... and the substituted strings convert cleanly
+    const ST::string past_max = ST::string::from_utf8("\xF4\x90\x80\x80x", ST_AUTO_SIZE,
+                                                      ST::substitute_invalid);
+    const char16_t past_max16[] = { 0xfffd, 0xfffd, 0xfffd, 0xfffd, 'x', 0 };
+    const char32_t past_max32[] = { 0xfffd, 0xfffd, 0xfffd, 0xfffd, 'x', 0 };
+    EXPECT_EQ(0, T_strcmp(past_max16, past_max.to_utf16().data()));
+    EXPECT_EQ(0, T_strcmp(past_max32, past_max.to_utf32().data()));
+
+    // The free transcoders see the same sequences as invalid
+    EXPECT_THROW({ (void)ST::utf8_to_utf16("\xF4\x90\x80\x80x", 5, ST::check_validity); }, ST::unicode_error);
+    EXPECT_EQ(0, T_strcmp(past_max16, ST::utf8_to_utf16("\xF4\x90\x80\x80x", 5,
+                                                         ST::substitute_invalid).data()));
+    EXPECT_EQ(0, T_strcmp(past_max32, ST::utf8_to_utf32("\xF4\x90\x80\x80x", 5,
+                                                         ST::substitute_invalid).data()));
+}
+
+TEST(string, validation_long)
+{
+    // Invalid data after a valid prefix long enough to take the word-at-a-
+    // time path, both inside and at the end of an 8-byte block
+    const char prefix[] = "An ASCII prefix \xc3\xa9 longer than a word";
+    for (size_t pad = 0; pad < 10; ++pad) {
+        const std::string input = prefix + std::string(pad, 'x')
+                                + "\x80" "abc" "\xE0\x80" "defghijk";
+        const std::string expected = prefix + std::string(pad, 'x')
+                                   + "\xef\xbf\xbd" "abc" "\xef\xbf\xbd\xef\xbf\xbd" "defghijk";
+
+        EXPECT_THROW({ (void)ST::string::from_utf8(input.c_str(), input.size(),
+                                                   ST::check_validity); }, ST::unicode_error);
+
+        const ST::string repaired = ST::string::from_utf8(input.c_str(), input.size(),
+                                                          ST::substitute_invalid);
+        EXPECT_EQ(0, T_strcmp(expected.c_str(), repaired.c_str()));
+        EXPECT_EQ(expected.size(), repaired.size());
+
+        // From an existing buffer, both copied and moved
+        ST::char_buffer buffer(input.c_str(), input.size());
+        EXPECT_EQ(repaired, ST::string(buffer, ST::substitute_invalid));
+        EXPECT_EQ(repaired, ST::string(std::move(buffer), ST::substitute_invalid));
+    }
+
+    // Valid data is passed through unchanged
+    const ST::string valid = ST::string::from_utf8(prefix, ST_AUTO_SIZE, ST::substitute_invalid);
+    EXPECT_EQ(0, T_strcmp(prefix, valid.c_str()));
+    EXPECT_EQ(valid, ST::string(ST::char_buffer(prefix, sizeof(prefix) - 1),
+                                ST::substitute_invalid));
+}
+
+TEST(string, is_ascii)
+{
+    const char long_ascii[] = "A pure ASCII string which is too long for inline storage";
+    const char long_utf8[] = "A UTF-8 string which is too long for inline storage \xc3\xa9";
+
+    EXPECT_TRUE(ST::string().is_ascii());
+    EXPECT_TRUE(ST_LITERAL("Short").is_ascii());
+    EXPECT_FALSE(ST_LITERAL("\xc3\xa9").is_ascii());
+    EXPECT_TRUE(ST::string::from_utf8(long_ascii).is_ascii());
+    EXPECT_FALSE(ST::string::from_utf8(long_utf8).is_ascii());
+    EXPECT_TRUE(ST::string::from_utf8(long_ascii, ST_AUTO_SIZE, ST::assume_valid).is_ascii());
+    EXPECT_FALSE(ST::string::from_utf8(long_utf8, ST_AUTO_SIZE, ST::assume_valid).is_ascii());
+    EXPECT_FALSE(ST::string::from_utf8("\xc3\xa9\x80 and some more text to make it long",
+                                       ST_AUTO_SIZE, ST::substitute_invalid).is_ascii());
+
+    // The recorded state follows copies and moves
+    const ST::string ascii = ST::string::from_utf8(long_ascii);
+    ST::string copy = ascii;
+    EXPECT_TRUE(copy.is_ascii());
+    ST::string moved = std::move(copy);
+    EXPECT_TRUE(moved.is_ascii());
+
+    // ...but not modifications to a buffer taken from the string
+    ST::char_buffer buffer = moved.release_buffer();
+    buffer[0] = '\xc3';
+    buffer[1] = '\xa9';
+    EXPECT_FALSE(ST::string(buffer, ST::assume_valid).is_ascii());
+    EXPECT_FALSE(ST::string(std::move(buffer), ST::check_validity).is_ascii());
+}
+
+TEST(string, ascii_conversions)
+{
+    const char long_ascii[] = "A pure ASCII string which is too long for inline storage";
+    const ST::string ascii = ST::string::from_utf8(long_ascii);
+    const size_t size = sizeof(long_ascii) - 1;
+
+    const ST::utf16_buffer utf16 = ascii.to_utf16();
+    const ST::utf32_buffer utf32 = ascii.to_utf32();
+    const ST::wchar_buffer wide = ascii.to_wchar();
+    const ST::char_buffer latin_1 = ascii.to_latin_1();
+    ASSERT_EQ(size, utf16.size());
+    ASSERT_EQ(size, utf32.size());
+    ASSERT_EQ(size, wide.size());
+    ASSERT_EQ(size, latin_1.size());
+    for (size_t i = 0; i < size; ++i) {
+        EXPECT_EQ(static_cast<char16_t>(long_ascii[i]), utf16[i]);
+        EXPECT_EQ(static_cast<char32_t>(long_ascii[i]), utf32[i]);
+        EXPECT_EQ(static_cast<wchar_t>(long_ascii[i]), wide[i]);
+        EXPECT_EQ(long_ascii[i], latin_1[i]);
+    }
+
+    EXPECT_EQ(ascii, ST::string::from_utf16(utf16));
+    EXPECT_EQ(ascii, ST::string::from_utf32(utf32));
+    EXPECT_EQ(ascii, ST::string::from_wchar(wide));
+    EXPECT_EQ(ascii, ST::string::from_latin_1(latin_1));
+}
+
+TEST(string, ascii_prefix_conversions)
+{
+    // An ASCII prefix is copied directly, and the rest is transcoded
+    // after it, including any errors
+    const char utf8[] = "ASCII prefix \xc3\xa9\xf0\x9f\x98\x80 tail";
+    const char16_t utf16[] = u"ASCII prefix \u00e9\U0001f600 tail";
+    const char32_t utf32[] = U"ASCII prefix \u00e9\U0001f600 tail";
+    const wchar_t wide[] = L"ASCII prefix \u00e9\U0001f600 tail";
+    const char latin_1[] = "ASCII prefix \xe9 tail";
+    const char utf8_latin_1[] = "ASCII prefix \xc3\xa9 tail";
+
+    EXPECT_EQ(0, T_strcmp(utf8, ST::utf16_to_utf8(utf16, text_size(utf16)).data()));
+    EXPECT_EQ(0, T_strcmp(utf8, ST::utf32_to_utf8(utf32, text_size(utf32)).data()));
+    EXPECT_EQ(0, T_strcmp(utf8, ST::wchar_to_utf8(wide, text_size(wide)).data()));
+    EXPECT_EQ(0, T_strcmp(utf8_latin_1, ST::latin_1_to_utf8(latin_1, text_size(latin_1)).data()));
+    EXPECT_EQ(0, T_strcmp(utf16, ST::utf8_to_utf16(utf8, text_size(utf8)).data()));
+    EXPECT_EQ(0, T_strcmp(utf32, ST::utf8_to_utf32(utf8, text_size(utf8)).data()));
+    EXPECT_EQ(0, T_strcmp(wide, ST::utf8_to_wchar(utf8, text_size(utf8)).data()));
+    EXPECT_EQ(0, T_strcmp(latin_1, ST::utf8_to_latin_1(utf8_latin_1, text_size(utf8_latin_1)).data()));
+
+    const char bad_utf8[] = "ASCII prefix \xc3";
+    EXPECT_THROW({ (void)ST::utf8_to_utf16(bad_utf8, text_size(bad_utf8), ST::check_validity); },
+                 ST::unicode_error);
+    EXPECT_THROW({ (void)ST::utf8_to_utf32(bad_utf8, text_size(bad_utf8), ST::check_validity); },
+                 ST::unicode_error);
+}
+
+TEST(string, code_points)
+{
+    // Mixed 1, 2, 3 and 4 byte sequences, long enough to exercise the
+    // vector and word-at-a-time paths and several index checkpoints
+    std::string source;
+    for (int i = 0; i < 100; ++i)
+        source += "a\xc3\xa9\xe2\x82\xac\xf0\x9f\x98\x80";
+    const ST::string str = ST::string::from_utf8(source.c_str(), source.size());
+    const ST::utf32_buffer utf32 = str.to_utf32();
+    ASSERT_EQ(400u, utf32.size());
+
+    EXPECT_EQ(0u, ST::string().code_point_count());
+    EXPECT_EQ(5u, ST_LITERAL("Short").code_point_count());
+    EXPECT_EQ(4u, ST_LITERAL("a\xc3\xa9\xe2\x82\xac\xf0\x9f\x98\x80").code_point_count());
+    EXPECT_EQ(utf32.size(), str.code_point_count());
+
+    const ST::code_point_index index(str);
+    EXPECT_EQ(utf32.size(), index.size());
+    EXPECT_EQ(0u, index.byte_offset(0));
+    EXPECT_EQ(str.size(), index.byte_offset(index.size()));
+    for (size_t i = 0; i < utf32.size(); ++i) {
+        EXPECT_EQ(utf32[i], str.code_point_at(i));
+        EXPECT_EQ(utf32[i], index.code_point_at(i));
+        EXPECT_EQ(10 * (i / 4) + (i % 4) * (i % 4 + 1) / 2, index.byte_offset(i));
+    }
+    EXPECT_THROW((void)str.code_point_at(utf32.size()), std::out_of_range);
+    EXPECT_THROW((void)index.code_point_at(utf32.size()), std::out_of_range);
+    EXPECT_THROW((void)index.byte_offset(utf32.size() + 1), std::out_of_range);
+
+    const ST::string expected = ST::string::from_utf32(utf32.data() + 61, 70);
+    EXPECT_EQ(expected, str.substr_code_points(61, 70));
+    EXPECT_EQ(expected, index.substr_code_points(61, 70));
+    EXPECT_EQ(ST::string::from_utf32(utf32.data() + 390, 10), str.substr_code_points(390));
+    EXPECT_EQ(ST::string::from_utf32(utf32.data() + 390, 10), index.substr_code_points(390, 100));
+    EXPECT_EQ(str, str.substr_code_points(0));
+    EXPECT_EQ(str, index.substr_code_points(0));
+    EXPECT_TRUE(str.substr_code_points(400).empty());
+    EXPECT_TRUE(index.substr_code_points(500, 1).empty());
+
+    // ASCII strings are indexed by byte
+    const ST::string ascii = ST_LITERAL("A pure ASCII string which is too long for inline storage");
+    const ST::code_point_index ascii_index(ascii);
+    EXPECT_EQ(ascii.size(), ascii.code_point_count());
+    EXPECT_EQ(ascii.size(), ascii_index.size());
+    EXPECT_EQ(char32_t('A'), ascii.code_point_at(0));
+    EXPECT_EQ(char32_t('e'), ascii_index.code_point_at(ascii.size() - 1));
+    EXPECT_EQ(ST_LITERAL("ASCII"), ascii.substr_code_points(7, 5));
+    EXPECT_EQ(ST_LITERAL("ASCII"), ascii_index.substr_code_points(7, 5));
+    EXPECT_EQ(ST_LITERAL("storage"), ascii.substr_code_points(ascii.size() - 7));
+    EXPECT_TRUE(ascii.substr_code_points(ascii.size() + 1).empty());
+    EXPECT_THROW((void)ascii.code_point_at(ascii.size()), std::out_of_range);
+}
+
+TEST(string, code_point_iterator)
+{
+    std::string source;
+    for (int i = 0; i < 20; ++i)
+        source += "a\xc3\xa9\xe2\x82\xac\xf0\x9f\x98\x80";
+    const ST::string str = ST::string::from_utf8(source.c_str(), source.size());
+    const ST::utf32_buffer utf32 = str.to_utf32();
+
+    const ST::string empty;
+    EXPECT_TRUE(empty.code_points().empty());
+    EXPECT_TRUE(empty.code_points().begin() == empty.code_points().end());
+
+    std::vector<char32_t> forward;
+    for (char32_t ch : str.code_points())
+        forward.push_back(ch);
+    ASSERT_EQ(utf32.size(), forward.size());
+    EXPECT_TRUE(std::equal(forward.begin(), forward.end(), utf32.begin()));
+    EXPECT_EQ(static_cast<std::ptrdiff_t>(utf32.size()),
+              std::distance(str.code_points().begin(), str.code_points().end()));
+
+    std::vector<char32_t> backward;
+    const ST::code_point_range range = str.code_points();
+    for (auto it = range.end(); it != range.begin(); )
+        backward.push_back(*--it);
+    ASSERT_EQ(utf32.size(), backward.size());
+    EXPECT_TRUE(std::equal(backward.rbegin(), backward.rend(), utf32.begin()));
+
+    // Decoding in blocks gives the same code points, with a short final block
+    std::vector<char32_t> blocks;
+    char32_t block[7];
+    auto it = range.begin();
+    size_t count;
+    while ((count = it.decode_block(block)) == 7)
+        blocks.insert(blocks.end(), block, block + count);
+    EXPECT_EQ(utf32.size() % 7, count);
+    blocks.insert(blocks.end(), block, block + count);
+    EXPECT_TRUE(it == range.end());
+    ASSERT_EQ(utf32.size(), blocks.size());
+    EXPECT_TRUE(std::equal(blocks.begin(), blocks.end(), utf32.begin()));
+
+    // Invalid bytes are read as substitutes in both directions
+    const ST::string invalid = ST::string::from_utf8("a\x80\xc3\xa9\xe2\x82z",
+                                                     ST_AUTO_SIZE, ST::assume_valid);
+    const char32_t expected[] = { 'a', 0xFFFD, 0xE9, 0xFFFD, 0xFFFD, 'z' };
+    std::vector<char32_t> invalid_forward(invalid.code_points().begin(),
+                                          invalid.code_points().end());
+    ASSERT_EQ(6u, invalid_forward.size());
+    EXPECT_TRUE(std::equal(invalid_forward.begin(), invalid_forward.end(), expected));
+    std::vector<char32_t> invalid_backward;
+    for (auto iter = invalid.code_points().end(); iter != invalid.code_points().begin(); )
+        invalid_backward.push_back(*--iter);
+    ASSERT_EQ(6u, invalid_backward.size());
+    EXPECT_TRUE(std::equal(invalid_backward.rbegin(), invalid_backward.rend(), expected));
+}
+
 TEST(string, conv_utf8_validation)
 {
     const char16_t truncL[] = { 0xd800, 'x', 0 };
@@ -954,6 +1224,45 @@ TEST(string, char_concatenation)
     EXPECT_EQ(ST::string(L"\u0100xxxxxxxxxxxxxxxx"), wchar_t(0x100) + input3);
 }
 
+TEST(string, concatenation_chain)
+{
+    const ST::string prefix = "settings.display.";
+    const ST::string key = "resolution_preset";
+    const ST::string value = "1920x1080 (widescreen, native)";
+    const ST::string expected = "settings.display.resolution_preset=1920x1080 (widescreen, native)\n";
+
+    ST::string result = prefix + key + "=" + value + "\n";
+    EXPECT_EQ(expected, result);
+
+    // The result of + is a real string, so it can be stored with auto and
+    // outlive its temporary operands, or used directly
+    auto stored = ST::string::from_int(42) + ST_LITERAL("!");
+    EXPECT_EQ(ST_LITERAL("42!"), stored);
+    EXPECT_EQ(0, T_strcmp("KEY=y", (ST_LITERAL("KEY=") + "y").c_str()));
+    EXPECT_EQ(ST_LITERAL("key=y"), (ST_LITERAL("KEY=") + "Y").to_lower());
+    const auto pair = std::make_pair(prefix + key, 1);
+    EXPECT_EQ(ST_LITERAL("settings.display.resolution_preset"), pair.first);
+
+    // ST::concat accepts the same mix of operands, built in one allocation
+    EXPECT_EQ(expected, ST::concat(prefix, key, '=', value, "\n"));
+    EXPECT_EQ(ST_LITERAL("<a\xc3\xa9\xe2\x82\xac\xf0\x9f\x98\x80z>"),
+              ST::concat('<', ST_LITERAL("a"), char16_t(0xe9), L"\u20ac",
+                         U"\U0001F600", u"z", char32_t('>')));
+    EXPECT_EQ(ST_LITERAL("42!"), ST::concat(ST::string::from_int(42), "!"));
+    EXPECT_EQ(ST::string(), ST::concat());
+    EXPECT_EQ(ST::string(), ST::concat("", ST::string()));
+
+    // Appending to the string being built from
+    result = ST_LITERAL("ab");
+    result = ST::concat(result, result, result);
+    EXPECT_EQ(ST_LITERAL("ababab"), result);
+
+    // Conversion errors are raised as with operator+
+    EXPECT_THROW((void)(prefix + key + char32_t(0x110000)), ST::unicode_error);
+    EXPECT_THROW((void)ST::concat(prefix, key, char32_t(0x110000)), ST::unicode_error);
+    EXPECT_THROW((void)ST::concat(prefix, key, "\xc3"), ST::unicode_error);
+}
+
 TEST(string, from_int)
 {
     EXPECT_EQ(ST_LITERAL("0"), ST::string::from_int(0));
@@ -1820,6 +2129,130 @@ TEST(string, trim)
     EXPECT_EQ(ST_LITERAL("xxx"), ST_LITERAL("\r\nxxx\r\n").trim(" \t\r\n"));
     EXPECT_EQ(ST_LITERAL("   xxx   "), ST_LITERAL("   xxx   ").trim("abc"));
     EXPECT_EQ(ST_LITERAL("   xxx   "), ST_LITERAL("   xxx   ").trim("x"));
+
+    const ST::char_set whitespace(ST_WHITESPACE);
+    EXPECT_EQ(ST_LITERAL("xxx \t"), ST_LITERAL("\r\n xxx \t").trim_left(whitespace));
+    EXPECT_EQ(ST_LITERAL("\r\n xxx"), ST_LITERAL("\r\n xxx \t").trim_right(whitespace));
+    EXPECT_EQ(ST_LITERAL("xxx"), ST_LITERAL("\r\n xxx \t").trim(whitespace));
+    EXPECT_EQ(ST_LITERAL("x x"), ST_LITERAL(" x x ").trim(whitespace));
+    EXPECT_EQ(ST_LITERAL(""), ST_LITERAL(" \t ").trim(whitespace));
+    EXPECT_EQ(ST_LITERAL(""), ST_LITERAL(" \t ").trim_left(whitespace));
+    EXPECT_EQ(ST_LITERAL(""), ST_LITERAL(" \t ").trim_right(whitespace));
+    EXPECT_EQ(ST_LITERAL(""), ST::string().trim(whitespace));
+    EXPECT_EQ(ST_LITERAL("xxx"), ST_LITERAL("xxx").trim(ST::char_set()));
+}
+
+TEST(string, char_set)
+{
+    ST::char_set set("abc");
+    EXPECT_TRUE(set.contains('a'));
+    EXPECT_TRUE(set.contains('c'));
+    EXPECT_FALSE(set.contains('d'));
+    EXPECT_FALSE(set.contains('\0'));
+    EXPECT_FALSE(set.contains('\xff'));
+
+    set.add('\xff');
+    set.add("\x80", 1);
+    set.add(std::string(1, '\0').c_str(), 1);
+    EXPECT_TRUE(set.contains('\xff'));
+    EXPECT_TRUE(set.contains('\x80'));
+    EXPECT_TRUE(set.contains('\0'));
+    EXPECT_FALSE(set.contains('\x7f'));
+
+    const char text[] = "xxabcyy";
+    const char *end = text + sizeof(text) - 1;
+    EXPECT_EQ(text + 2, set.find(text, end));
+    EXPECT_EQ(end, set.find(text + 5, end));
+    EXPECT_EQ(text + 5, set.skip(text + 2, end));
+    EXPECT_EQ(text + 2, set.skip_back(text, text + 5));
+    EXPECT_EQ(text + 2, set.skip_back(text + 2, text + 5));
+}
+
+TEST(string, join)
+{
+    const std::vector<ST::string> empty;
+    EXPECT_EQ(ST::string(), ST::join(empty, ST_LITERAL(", ")));
+
+    const std::vector<ST::string> single { ST_LITERAL("one") };
+    EXPECT_EQ(ST_LITERAL("one"), ST::join(single, ST_LITERAL(", ")));
+
+    const std::vector<ST::string> items {
+        ST_LITERAL("one"), ST_LITERAL("two"), ST::string(), ST_LITERAL("\xe2\x82\xac")
+    };
+    EXPECT_EQ(ST_LITERAL("one, two, , \xe2\x82\xac"), ST::join(items, ST_LITERAL(", ")));
+    EXPECT_EQ(ST_LITERAL("onetwo\xe2\x82\xac"), ST::join(items, ST::string()));
+
+    const ST::string joined = ST::join(items, ST_LITERAL("/"));
+    EXPECT_EQ(joined.size(), strlen(joined.c_str()));
+
+    const ST::string array[] = { ST_LITERAL("a"), ST_LITERAL("b") };
+    EXPECT_EQ(ST_LITERAL("a+b"), ST::join(array, ST_LITERAL("+")));
+
+#if defined(ST_ENABLE_STL_STRINGS) && defined(ST_HAVE_CXX17_STRING_VIEW)
+    const std::vector<std::string_view> views { "key", "value" };
+    EXPECT_EQ(ST_LITERAL("key=value"), ST::join(views, ST_LITERAL("=")));
+#endif
+}
+
+TEST(string, transparent_lookup)
+{
+    const ST::string key = ST_LITERAL("Key");
+
+    EXPECT_EQ(ST::hash()(key), ST::hash()("Key"));
+    EXPECT_EQ(ST::hash_i()(key), ST::hash_i()("kEY"));
+    EXPECT_EQ(ST::hash()(ST::string()), ST::hash()(static_cast<const char *>(nullptr)));
+    EXPECT_TRUE(ST::equal()(key, "Key"));
+    EXPECT_FALSE(ST::equal()("Key", key + "s"));
+    EXPECT_TRUE(ST::equal_i()("KEY", key));
+    EXPECT_FALSE(ST::equal_i()(key, "Keys"));
+    EXPECT_TRUE(ST::less()(key, "key"));
+    EXPECT_FALSE(ST::less_i()(key, "key"));
+    EXPECT_TRUE(ST::less_i()("KEY", ST_LITERAL("keys")));
+
+    std::map<ST::string, int, ST::less_i> ordered;
+    ordered[ST_LITERAL("Alpha")] = 1;
+    ordered[ST_LITERAL("beta")] = 2;
+    EXPECT_EQ(1, ordered.find("ALPHA")->second);
+    EXPECT_EQ(ordered.end(), ordered.find("gamma"));
+
+    std::unordered_map<ST::string, int, ST::hash, ST::equal> unordered;
+    unordered[ST_LITERAL("Alpha")] = 1;
+    unordered[ST_LITERAL("beta")] = 2;
+    EXPECT_EQ(2, unordered.find("beta")->second);
+    EXPECT_EQ(unordered.end(), unordered.find("Beta"));
+
+#if defined(ST_ENABLE_STL_STRINGS)
+    EXPECT_EQ(ST::hash()(key), ST::hash()(std::string("Key")));
+    EXPECT_EQ(1, ordered.find(std::string("alpha"))->second);
+#if defined(ST_HAVE_CXX17_STRING_VIEW)
+    EXPECT_TRUE(ST::equal()(std::string_view("Key"), key));
+    EXPECT_EQ(2, unordered.find(std::string_view("beta"))->second);
+#endif
+#endif
+}
+
+TEST(string, hash_literal)
+{
+    static_assert(ST::hash_literal("") != ST::hash_literal("GET"),
+                  "hash_literal should be usable in constant expressions");
+
+    EXPECT_EQ(ST::hash()(ST::string()), ST::hash_literal(""));
+    EXPECT_EQ(ST::hash()(ST_LITERAL("GET")), ST::hash_literal("GET"));
+    EXPECT_EQ(ST::hash()(ST_LITERAL("\xe2\x82\xac 100")), ST::hash_literal("\xe2\x82\xac 100"));
+
+    const ST::string method = ST_LITERAL("PUT");
+    int matched = 0;
+    switch (ST::hash()(method)) {
+    case ST::hash_literal("GET"):
+        matched = 1;
+        break;
+    case ST::hash_literal("PUT"):
+        matched = (method == "PUT") ? 2 : 0;
+        break;
+    default:
+        break;
+    }
+    EXPECT_EQ(2, matched);
 }
 
 TEST(string, substrings)
@@ -2000,6 +2433,12 @@ TEST(string, tokenize)
     // tokenize will return an empty vector if there are no tokens in the input
     EXPECT_EQ(std::vector<ST::string>(), ST_LITERAL("\t;\n;").tokenize("\t\n-;"));
     EXPECT_EQ(std::vector<ST::string>(), ST_LITERAL("").tokenize("\t\n-;"));
+
+    // A prebuilt set gives the same results
+    const ST::char_set delims("\t\n-;");
+    EXPECT_EQ(expected1, input1.tokenize(delims));
+    EXPECT_EQ(expected1, input2.tokenize(delims));
+    EXPECT_EQ(std::vector<ST::string>(), ST_LITERAL("\t;\n;").tokenize(delims));
 }
 
 TEST(string, split)
@@ -0,0 +1,180 @@
+/*  Copyright (c) 2026 Michael Hansen
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in
+    all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE. */
+
+#include "st_stringbuilder.h"
+
+#include <gtest/gtest.h>
+#include <sstream>
+
+namespace ST
+{
+    // Teach GTest how to print an ST::string
+    static void PrintTo(const ST::string &str, std::ostream *os)
+    {
+        *os << "ST::string{\"" << str.c_str() << "\"}";
+    }
+}
+
+#if defined(_MSC_VER)
+#   pragma warning(disable: 4996)
+#endif
+
+TEST(string_builder, empty)
+{
+    ST::string_builder sb;
+    EXPECT_TRUE(sb.empty());
+    EXPECT_EQ(0U, sb.size());
+    EXPECT_EQ(ST_LITERAL(""), sb.to_string());
+
+    sb << "" << ST::string();
+    EXPECT_EQ(0U, sb.chunk_count());
+    EXPECT_EQ(ST_LITERAL(""), sb.to_string());
+}
+
+TEST(string_builder, append)
+{
+    ST::string long_str("0123456789abcdefghij0123456789abcdefghij");
+    ST::string_builder sb;
+    sb << "Hello" << ST_LITERAL(", ") << long_str;
+    sb.append("xyzzy", 3);
+    EXPECT_EQ(4U, sb.chunk_count());
+    EXPECT_EQ(50U, sb.size());
+    EXPECT_EQ(ST_LITERAL("Hello, 0123456789abcdefghij0123456789abcdefghijxyz"),
+              sb.to_string());
+
+    ST::string moved = long_str;
+    ST::string_builder sb2;
+    sb2 << std::move(moved);
+    EXPECT_TRUE(moved.empty());
+    EXPECT_EQ(long_str, sb2.to_string());
+
+    sb2.append(std::move(sb));
+    EXPECT_TRUE(sb.empty());
+    EXPECT_EQ(5U, sb2.chunk_count());
+    EXPECT_EQ(ST_LITERAL("0123456789abcdefghij0123456789abcdefghij"
+                         "Hello, 0123456789abcdefghij0123456789abcdefghijxyz"),
+              sb2.to_string());
+}
+
+TEST(string_builder, insert)
+{
+    ST::string_builder sb;
+    sb.insert(0, ST_LITERAL("world"));
+    sb.insert(0, ST_LITERAL("Hello "));
+    sb.insert(sb.size(), ST_LITERAL("!"));
+    EXPECT_EQ(ST_LITERAL("Hello world!"), sb.to_string());
+
+    // Insert on a chunk boundary
+    sb.insert(6, ST_LITERAL("big "));
+    EXPECT_EQ(ST_LITERAL("Hello big world!"), sb.to_string());
+    EXPECT_EQ(4U, sb.chunk_count());
+
+    // Insert inside a chunk
+    sb.insert(2, ST_LITERAL("~"));
+    EXPECT_EQ(ST_LITERAL("He~llo big world!"), sb.to_string());
+    sb.insert(13, ST_LITERAL("_"));
+    EXPECT_EQ(ST_LITERAL("He~llo big wo_rld!"), sb.to_string());
+    EXPECT_EQ(18U, sb.size());
+
+    sb.append(ST_LITERAL("?"));
+    sb.insert(18, ST_LITERAL("."));
+    EXPECT_EQ(ST_LITERAL("He~llo big wo_rld!.?"), sb.to_string());
+}
+
+TEST(string_builder, insert_utf8)
+{
+    ST::string_builder sb;
+    sb << ST_LITERAL("a\xc3\xa9") << ST_LITERAL("\xe2\x82\xac" "b");
+    EXPECT_THROW(sb.insert(2, ST_LITERAL("x")), std::invalid_argument);
+    EXPECT_THROW(sb.insert(4, ST_LITERAL("x")), std::invalid_argument);
+    EXPECT_THROW(sb.insert(5, ST_LITERAL("x")), std::invalid_argument);
+    EXPECT_THROW(sb.insert(8, ST_LITERAL("x")), std::out_of_range);
+
+    // A failed insert leaves the builder untouched
+    EXPECT_EQ(2U, sb.chunk_count());
+    EXPECT_EQ(ST_LITERAL("a\xc3\xa9\xe2\x82\xac" "b"), sb.to_string());
+
+    sb.insert(1, ST_LITERAL("x"));
+    sb.insert(4, ST_LITERAL("y"));
+    sb.insert(8, ST_LITERAL("z"));
+    EXPECT_EQ(ST_LITERAL("ax\xc3\xa9y\xe2\x82\xac" "zb"), sb.to_string());
+}
+
+TEST(string_builder, many_chunks)
+{
+    // Compare a long series of appends, inserts and joins against the same
+    // edits made to a flat std::string
+    ST::string_builder sb;
+    std::string expected;
+    unsigned seed = 12345;
+    for (int i = 0; i < 2000; ++i) {
+        seed = seed * 1103515245U + 12345U;
+        const std::string fragment(1 + (seed >> 16) % 12, static_cast<char>('a' + i % 26));
+        const size_t pos = (seed >> 8) % (expected.size() + 1);
+        if (i % 3 == 0) {
+            sb.append(fragment.c_str(), fragment.size());
+            expected += fragment;
+        } else {
+            sb.insert(pos, ST::string(fragment.c_str(), fragment.size()));
+            expected.insert(pos, fragment);
+        }
+    }
+    EXPECT_EQ(expected.size(), sb.size());
+    EXPECT_EQ(ST::string(expected), sb.to_string());
+
+    ST::string_builder copy = sb;
+    copy.insert(0, ST_LITERAL("<"));
+    sb.append(std::move(copy));
+    EXPECT_TRUE(copy.empty());
+    EXPECT_EQ(ST::string(expected + "<" + expected), sb.to_string());
+
+    std::ostringstream os;
+    sb.write_to(os);
+    EXPECT_EQ(expected + "<" + expected, os.str());
+}
+
+TEST(string_builder, write)
+{
+    ST::string_builder sb;
+    ST::string big(ST::char_buffer(300, 'x'));
+    sb << "abc" << big << "def";
+    for (int i = 0; i < 100; ++i)
+        sb << "0123456789";
+    const ST::string expected = sb.to_string();
+
+    std::ostringstream os;
+    sb.write_to(os);
+    EXPECT_EQ(expected, ST::string(os.str()));
+
+    FILE *test_f = fopen("st_test.out", "wb");
+    ST_ASSERT(test_f, "Could not open output file for test");
+    sb.write_to(test_f);
+    fclose(test_f);
+
+    test_f = fopen("st_test.out", "rb");
+    ST_ASSERT(test_f, "Could not open output file for test");
+    ST::char_buffer result;
+    result.allocate(expected.size());
+    const size_t count = fread(result.data(), sizeof(char), result.size(), test_f);
+    fclose(test_f);
+
+    EXPECT_EQ(expected.size(), count);
+    EXPECT_EQ(expected, ST::string(result));
+}
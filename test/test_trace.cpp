@@ -0,0 +1,103 @@
+/*  Copyright (c) 2026 Michael Hansen
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in
+    all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE. */
+
+#include "st_trace.h"
+#include "st_format.h"
+
+#include <gtest/gtest.h>
+
+static const char text_utf8[] = "Text with a non-ASCII \xc3\xa9 character";
+
+TEST(trace, disabled)
+{
+    if (ST::trace_stats::enabled())
+        GTEST_SKIP() << "Built with ST_ENABLE_TRACING";
+
+    // The trace point and its arguments compile away entirely
+    int evaluated = 0;
+    _ST_TRACE_SCOPE(trace_replace, ++evaluated);
+    EXPECT_EQ(0, evaluated);
+
+    const ST::string str = ST::string::from_utf8(text_utf8);
+    (void)str.to_utf16();
+    const ST::trace_stats stats = ST::trace_stats::snapshot();
+    for (const ST::trace_counter &counter : stats.events) {
+        EXPECT_EQ(0u, counter.calls);
+        EXPECT_EQ(0u, counter.bytes);
+        EXPECT_EQ(0u, counter.ticks);
+    }
+    EXPECT_EQ(nullptr, ST::set_trace_callback(nullptr));
+}
+
+TEST(trace, counters)
+{
+    if (!ST::trace_stats::enabled())
+        GTEST_SKIP() << "Built without ST_ENABLE_TRACING";
+
+    const size_t text_size = sizeof(text_utf8) - 1;
+    ST::trace_stats before = ST::trace_stats::snapshot();
+    const ST::string str = ST::string::from_utf8(text_utf8);
+    ST::trace_stats stats = ST::trace_stats::snapshot() - before;
+    EXPECT_EQ(1u, stats[ST::trace_validate_utf8].calls);
+    EXPECT_EQ(text_size, stats[ST::trace_validate_utf8].bytes);
+    EXPECT_EQ(0u, stats[ST::trace_transcode].calls);
+
+    before = ST::trace_stats::snapshot();
+    ST::utf16_buffer utf16 = str.to_utf16();
+    ST::string result = ST::format("{}", str.replace("Text", "String"));
+    stats = ST::trace_stats::snapshot() - before;
+    EXPECT_EQ(1u, stats[ST::trace_transcode].calls);
+    EXPECT_EQ(text_size, stats[ST::trace_transcode].bytes);
+    EXPECT_EQ(1u, stats[ST::trace_format].calls);
+    EXPECT_EQ(1u, stats[ST::trace_replace].calls);
+    EXPECT_EQ(text_size, stats[ST::trace_replace].bytes);
+    EXPECT_EQ(str.size() + 2, result.size());
+
+    ST::trace_stats::reset();
+    stats = ST::trace_stats::snapshot();
+    EXPECT_EQ(0u, stats[ST::trace_format].calls);
+}
+
+static size_t callback_calls[ST::trace_event_count];
+static size_t callback_bytes[ST::trace_event_count];
+
+static void count_events(ST::trace_event_t event, size_t bytes, unsigned long long)
+{
+    callback_calls[static_cast<size_t>(event)] += 1;
+    callback_bytes[static_cast<size_t>(event)] += bytes;
+}
+
+TEST(trace, callback)
+{
+    if (!ST::trace_stats::enabled())
+        GTEST_SKIP() << "Built without ST_ENABLE_TRACING";
+
+    EXPECT_EQ(nullptr, ST::set_trace_callback(count_events));
+    ST::string str = ST::string::from_utf8(text_utf8);
+    (void)str.to_utf32();
+    EXPECT_EQ(count_events, ST::set_trace_callback(nullptr));
+    (void)str.to_utf32();
+
+    EXPECT_EQ(1u, callback_calls[static_cast<size_t>(ST::trace_validate_utf8)]);
+    EXPECT_EQ(sizeof(text_utf8) - 1,
+              callback_bytes[static_cast<size_t>(ST::trace_validate_utf8)]);
+    EXPECT_EQ(1u, callback_calls[static_cast<size_t>(ST::trace_transcode)]);
+    EXPECT_EQ(0u, callback_calls[static_cast<size_t>(ST::trace_format)]);
+}